@@ -0,0 +1,1298 @@
+#include <fstream>
+#include <print>
+//
+#include <ensketch/sandbox/ambient_occlusion.hpp>
+#include <ensketch/sandbox/closest_point.hpp>
+#include <ensketch/sandbox/cpu_renderer.hpp>
+#include <ensketch/sandbox/halfedge_connectivity.hpp>
+#include <ensketch/sandbox/kd_tree.hpp>
+#include <ensketch/sandbox/mesh_decimation.hpp>
+#include <ensketch/sandbox/mesh_reordering.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+#include <ensketch/sandbox/quantized_vertices.hpp>
+#include <ensketch/sandbox/ray_tracer.hpp>
+#include <ensketch/sandbox/selection.hpp>
+#include <ensketch/sandbox/stl_stream.hpp>
+#include <ensketch/sandbox/stl_surface.hpp>
+#include <ensketch/sandbox/surface_segmentation.hpp>
+#include <ensketch/sandbox/vertex_one_rings.hpp>
+
+using namespace ensketch::sandbox;
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+using duration = std::chrono::duration<float64, std::milli>;
+
+// Run `f` several times and return the minimal run time in milliseconds.
+//
+auto time_of(auto&& f, int runs = 3) -> float64 {
+  auto result = std::numeric_limits<float64>::infinity();
+  for (int i = 0; i < runs; ++i) {
+    const auto start = clock::now();
+    std::invoke(f);
+    const auto end = clock::now();
+    result = std::min(result, duration(end - start).count());
+  }
+  return result;
+}
+
+// Triangulated grid of `n` times `n` quads with `2 n^2` faces.
+//
+struct grid {
+  using face = std::array<uint32, 3>;
+
+  explicit grid(uint32 n) : vertex_count{(n + 1) * (n + 1)} {
+    faces.reserve(2 * size_t(n) * n);
+    const auto id = [n](uint32 i, uint32 j) { return i * (n + 1) + j; };
+    for (uint32 i = 0; i < n; ++i) {
+      for (uint32 j = 0; j < n; ++j) {
+        faces.push_back({id(i, j), id(i + 1, j), id(i + 1, j + 1)});
+        faces.push_back({id(i, j), id(i + 1, j + 1), id(i, j + 1)});
+      }
+    }
+  }
+
+  size_t vertex_count;
+  std::vector<face> faces{};
+};
+
+// The former edge storage of `polyhedral_surface` as baseline.
+//
+struct edge_map {
+  struct edge : std::array<uint32, 2> {
+    struct hasher {
+      auto operator()(const edge& e) const noexcept -> size_t {
+        return (size_t(e[0]) << 7) ^ size_t(e[1]);
+      }
+    };
+  };
+
+  explicit edge_map(const std::vector<grid::face>& faces) {
+    for (size_t i = 0; i < faces.size(); ++i) {
+      const auto& f = faces[i];
+      edges[edge{f[0], f[1]}] = i;
+      edges[edge{f[1], f[2]}] = i;
+      edges[edge{f[2], f[0]}] = i;
+    }
+  }
+
+  std::unordered_map<edge, uint32, edge::hasher> edges{};
+};
+
+void bench_halfedge_connectivity(uint32 n) {
+  const grid mesh{n};
+
+  // Random oriented edges as queries, as done by curve operations.
+  //
+  std::mt19937 rng{n};
+  std::vector<std::array<uint32, 2>> queries(1 << 20);
+  for (auto& q : queries) {
+    const auto& f = mesh.faces[rng() % mesh.faces.size()];
+    const auto k = rng() % 3;
+    q = {f[k], f[(k + 1) % 3]};
+  }
+
+  std::optional<edge_map> map{};
+  const auto map_build = time_of([&] { map.emplace(mesh.faces); }, 1);
+  size_t map_hits = 0;
+  const auto map_lookup = time_of([&] {
+    map_hits = 0;
+    for (const auto& [p, q] : queries)
+      map_hits += map->edges.contains(edge_map::edge{p, q});
+  });
+  map.reset();
+
+  halfedge_connectivity connectivity{};
+  const auto csr_build = time_of([&] {
+    connectivity = halfedge_connectivity_from(mesh.faces, mesh.vertex_count);
+  });
+  size_t csr_hits = 0;
+  const auto csr_lookup = time_of([&] {
+    csr_hits = 0;
+    for (const auto& [p, q] : queries) csr_hits += connectivity.contains(p, q);
+  });
+
+  if (map_hits != csr_hits)
+    throw std::runtime_error("Edge lookups of map and CSR differ.");
+
+  std::println("halfedge_connectivity: {} faces, {} threads", mesh.faces.size(),
+               thread_count());
+  std::println("  unordered_map build  {:10.2f} ms", map_build);
+  std::println("  CSR build            {:10.2f} ms", csr_build);
+  std::println("  unordered_map lookup {:10.2f} ns/query",
+               1e6 * map_lookup / queries.size());
+  std::println("  CSR lookup           {:10.2f} ns/query",
+               1e6 * csr_lookup / queries.size());
+}
+
+void bench_generate_edges(uint32 n) {
+  const grid mesh{n};
+  polyhedral_surface surface{};
+  surface.vertices.resize(mesh.vertex_count);
+  for (uint32 i = 0; i <= n; ++i)
+    for (uint32 j = 0; j <= n; ++j)
+      surface.vertices[i * (n + 1) + j].position = {i, j, (i * j) % 7};
+  surface.faces.resize(mesh.faces.size());
+  for (size_t i = 0; i < mesh.faces.size(); ++i)
+    surface.faces[i] = {mesh.faces[i]};
+
+  // Baseline: Serial map insertion followed by a pass over the map.
+  //
+  const auto serial = time_of(
+      [&] {
+        const edge_map map{mesh.faces};
+        std::vector<size_t> neighbor_count(surface.vertices.size());
+        std::vector<float> mean_edge_length(surface.vertices.size());
+        std::vector<float> max_edge_length(surface.vertices.size());
+        for (const auto& [e, _] : map.edges) {
+          ++neighbor_count[e[0]];
+          const auto l = distance(surface.vertices[e[0]].position,
+                                  surface.vertices[e[1]].position);
+          mean_edge_length[e[0]] += l;
+          max_edge_length[e[0]] = std::max(max_edge_length[e[0]], l);
+          max_edge_length[e[1]] = std::max(max_edge_length[e[1]], l);
+        }
+        for (size_t i = 0; i < surface.vertices.size(); ++i)
+          mean_edge_length[i] /= neighbor_count[i];
+      },
+      1);
+  const auto parallel = time_of([&] { surface.generate_edges(); });
+
+  std::println("generate_edges: {} faces, {} threads", mesh.faces.size(),
+               thread_count());
+  std::println("  serial map + statistics {:10.2f} ms", serial);
+  std::println("  parallel CSR + one pass {:10.2f} ms", parallel);
+}
+
+// Grid surface with some bumps to get faces of varying orientation.
+//
+auto surface_from(const grid& mesh, uint32 n) -> polyhedral_surface {
+  polyhedral_surface surface{};
+  surface.vertices.resize(mesh.vertex_count);
+  for (uint32 i = 0; i <= n; ++i)
+    for (uint32 j = 0; j <= n; ++j)
+      surface.vertices[i * (n + 1) + j].position = {
+          float32(i), float32(j), 5 * std::sin(0.1f * i) * std::cos(0.1f * j)};
+  surface.faces.resize(mesh.faces.size());
+  for (size_t i = 0; i < mesh.faces.size(); ++i)
+    surface.faces[i] = {mesh.faces[i]};
+  return surface;
+}
+
+void bench_one_rings(uint32 n) {
+  const grid mesh{n};
+  const auto connectivity =
+      halfedge_connectivity_from(mesh.faces, mesh.vertex_count);
+  vertex_one_rings rings{};
+  const auto build =
+      time_of([&] { rings = vertex_one_rings_from(mesh.faces, connectivity); });
+
+  // Face `i` of every one-ring has to lie between neighbor `i` and `i + 1`.
+  // Interior vertices of the grid have six neighbors in a closed cycle.
+  //
+  for (uint32 v = 0; v < mesh.vertex_count; ++v) {
+    const auto vertices = rings.vertices_of(v);
+    const auto faces = rings.faces_of(v);
+    const auto i = v / (n + 1);
+    const auto j = v % (n + 1);
+    const bool boundary = (i == 0) || (j == 0) || (i == n) || (j == n);
+    if ((vertices.size() != faces.size() + boundary) ||
+        (!boundary && (vertices.size() != 6)))
+      throw std::runtime_error("One-ring has wrong size.");
+    for (size_t k = 0; k < faces.size(); ++k) {
+      const auto& f = mesh.faces[faces[k]];
+      const auto a = vertices[k];
+      const auto b = vertices[(k + 1) % vertices.size()];
+      if ((std::ranges::find(f, a) == f.end()) ||
+          (std::ranges::find(f, b) == f.end()))
+        throw std::runtime_error("One-ring is not cyclically ordered.");
+    }
+  }
+
+  // Random unoriented edge queries, as done by curve regularization.
+  //
+  std::mt19937 rng{n};
+  std::vector<std::array<uint32, 2>> queries(1 << 20);
+  const auto vertex_count = uint32(mesh.vertex_count);
+  for (auto& q : queries) q = {rng() % vertex_count, rng() % vertex_count};
+  for (size_t k = 0; k < queries.size(); k += 2) {
+    const auto v = queries[k][0];
+    queries[k][1] = rings.vertices_of(v)[rng() % rings.vertices_of(v).size()];
+  }
+  size_t csr_hits = 0;
+  const auto csr_lookup = time_of([&] {
+    csr_hits = 0;
+    for (const auto& [p, q] : queries)
+      csr_hits += connectivity.contains(p, q) || connectivity.contains(q, p);
+  });
+  size_t ring_hits = 0;
+  const auto ring_lookup = time_of([&] {
+    ring_hits = 0;
+    for (const auto& [p, q] : queries) ring_hits += rings.contains(p, q);
+  });
+  if (csr_hits != ring_hits)
+    throw std::runtime_error("Edge lookups of CSR and one-rings differ.");
+
+  std::println("vertex_one_rings: {} faces, {} threads", mesh.faces.size(),
+               thread_count());
+  std::println("  build                {:10.2f} ms", build);
+  std::println("  CSR lookup, both     {:10.2f} ns/query",
+               1e6 * csr_lookup / queries.size());
+  std::println("  one-ring lookup      {:10.2f} ns/query",
+               1e6 * ring_lookup / queries.size());
+}
+
+void bench_bvh(uint32 n) {
+  const grid mesh{n};
+  const auto surface = surface_from(mesh, n);
+
+  // Random rays from above, like primary rays of a camera looking down.
+  //
+  std::mt19937 rng{n};
+  std::uniform_real_distribution<float32> coordinate{0.0f, float32(n)};
+  std::uniform_real_distribution<float32> tilt{-0.5f, 0.5f};
+  std::vector<ray> rays(1 << 12);
+  for (auto& r : rays)
+    r = {{coordinate(rng), coordinate(rng), 20.0f},
+         normalize(vec3{tilt(rng), tilt(rng), -1.0f})};
+
+  bvh tree{};
+  const auto build = time_of([&] { tree = bvh_from(surface); });
+
+  std::vector<ray_polyhedral_surface_intersection> linear_hits(rays.size());
+  std::vector<ray_polyhedral_surface_intersection> bvh_hits(rays.size());
+  const auto linear = time_of(
+      [&] {
+        for (size_t i = 0; i < rays.size(); ++i)
+          linear_hits[i] = intersection(rays[i], surface);
+      },
+      1);
+  const auto traversal = time_of([&] {
+    for (size_t i = 0; i < rays.size(); ++i)
+      bvh_hits[i] = intersection(rays[i], surface, tree);
+  });
+
+  for (size_t i = 0; i < rays.size(); ++i)
+    if ((linear_hits[i].f != bvh_hits[i].f) ||
+        (linear_hits[i].t != bvh_hits[i].t))
+      throw std::runtime_error("Intersections of BVH and linear scan differ.");
+
+  std::println("bvh: {} faces, {} nodes, {} threads", mesh.faces.size(),
+               tree.nodes.size(), thread_count());
+  std::println("  build        {:10.2f} ms", build);
+  std::println("  linear scan  {:10.2f} us/ray", 1e3 * linear / rays.size());
+  std::println("  traversal    {:10.2f} us/ray",
+               1e3 * traversal / rays.size());
+}
+
+void bench_refit(uint32 n) {
+  const grid mesh{n};
+  const auto surface = surface_from(mesh, n);
+  auto tree = bvh_from(surface);
+
+  // Move the bumps of the surface like an animation after many frames.
+  //
+  auto moved = surface;
+  for (auto& v : moved.vertices)
+    v.position.z = 5 * std::sin(0.1f * v.position.x + 2.0f) *
+                   std::cos(0.1f * v.position.y + 1.0f);
+  std::vector<aabb3> boxes(moved.faces.size());
+  for (size_t i = 0; i < moved.faces.size(); ++i) {
+    const auto& f = moved.faces[i];
+    const auto& v = moved.vertices;
+    boxes[i] = aabb3{aabb3{v[f[0]].position, v[f[1]].position},
+                     v[f[2]].position};
+  }
+
+  bvh rebuilt{};
+  const auto build = time_of([&] { rebuilt = bvh_from(boxes); });
+  const auto update = time_of([&] { refit(tree, boxes); });
+
+  std::mt19937 rng{n};
+  std::uniform_real_distribution<float32> coordinate{0.0f, float32(n)};
+  std::vector<ray> rays(1 << 12);
+  for (auto& r : rays)
+    r = {{coordinate(rng), coordinate(rng), 20.0f}, {0.0f, 0.0f, -1.0f}};
+
+  std::vector<ray_polyhedral_surface_intersection> refit_hits(rays.size());
+  std::vector<ray_polyhedral_surface_intersection> rebuilt_hits(rays.size());
+  const auto refit_traversal = time_of([&] {
+    for (size_t i = 0; i < rays.size(); ++i)
+      refit_hits[i] = intersection(rays[i], moved, tree);
+  });
+  const auto rebuilt_traversal = time_of([&] {
+    for (size_t i = 0; i < rays.size(); ++i)
+      rebuilt_hits[i] = intersection(rays[i], moved, rebuilt);
+  });
+
+  for (size_t i = 0; i < rays.size(); ++i)
+    if ((refit_hits[i].f != rebuilt_hits[i].f) ||
+        (refit_hits[i].t != rebuilt_hits[i].t))
+      throw std::runtime_error("Intersections of refit and rebuild differ.");
+
+  std::println("bvh refit: {} faces, {} threads", mesh.faces.size(),
+               thread_count());
+  std::println("  rebuild                {:10.2f} ms", build);
+  std::println("  refit                  {:10.2f} ms", update);
+  std::println("  traversal of rebuilt   {:10.2f} us/ray",
+               1e3 * rebuilt_traversal / rays.size());
+  std::println("  traversal of refitted  {:10.2f} us/ray",
+               1e3 * refit_traversal / rays.size());
+}
+
+// The former scalar linear scan as baseline.
+//
+auto scalar_intersection(const ray& r, const polyhedral_surface& surface)
+    -> ray_polyhedral_surface_intersection {
+  ray_polyhedral_surface_intersection result{};
+  result.t = infinity;
+  for (size_t i = 0; i < surface.faces.size(); ++i) {
+    const auto& v = surface.vertices;
+    const auto& f = surface.faces[i];
+    if (const auto p = intersection(
+            r, {v[f[0]].position, v[f[1]].position, v[f[2]].position})) {
+      if (p.t >= result.t) continue;
+      static_cast<ray_triangle_intersection&>(result) = p;
+      result.f = i;
+    }
+  }
+  return result;
+}
+
+// Compare the SIMD kernels with the scalar test on random input.
+// Hits may only differ if the ray passes a triangle's boundary
+// within the tolerance. Otherwise, all parameters need to agree.
+//
+void check_simd_kernels() {
+  constexpr float32 tolerance = 1e-4f;
+  std::mt19937 rng{0};
+  std::uniform_real_distribution<float32> coordinate{-1.0f, 1.0f};
+  const auto point = [&] {
+    return vec3{coordinate(rng), coordinate(rng), coordinate(rng)};
+  };
+
+  const auto check = [&](const ray_triangle_intersection& scalar,
+                         bool scalar_hit,
+                         const ray_triangle_packet_intersection& packet,
+                         size_t lane) {
+    const bool packet_hit = packet.mask & (1u << lane);
+    const auto& [u, v, t] = scalar;
+    const auto boundary = std::min({std::abs(u), std::abs(v),
+                                    std::abs(1.0f - u - v), std::abs(t)});
+    if (boundary < tolerance) return;
+    if (scalar_hit != packet_hit)
+      throw std::runtime_error("SIMD kernel and scalar test disagree on hit.");
+    if (!scalar_hit) return;
+    const auto near = [&](float32 x, float32 y) {
+      return std::abs(x - y) <= tolerance * (1.0f + std::abs(x));
+    };
+    if (!near(u, packet.u[lane]) || !near(v, packet.v[lane]) ||
+        !near(t, packet.t[lane]))
+      throw std::runtime_error("SIMD kernel and scalar test disagree.");
+  };
+
+  size_t hits = 0;
+  for (size_t iteration = 0; iteration < (1 << 16); ++iteration) {
+    array<ray, simd::width> rays{};
+    array<triangle, simd::width> triangles{};
+    triangle_packet triangle_lanes{};
+    ray_packet ray_lanes{};
+    for (size_t lane = 0; lane < simd::width; ++lane) {
+      rays[lane] = {point(), normalize(point() - point())};
+      triangles[lane] = {point(), point(), point()};
+      triangle_lanes.set(lane, triangles[lane]);
+      ray_lanes.set(lane, rays[lane]);
+    }
+    const auto one_ray = intersection(rays[0], triangle_lanes);
+    const auto one_triangle = intersection(ray_lanes, triangles[0]);
+    for (size_t lane = 0; lane < simd::width; ++lane) {
+      const auto p = intersection(rays[0], triangles[lane]);
+      check(p, bool(p), one_ray, lane);
+      const auto q = intersection(rays[lane], triangles[0]);
+      check(q, bool(q), one_triangle, lane);
+      hits += bool(p) + bool(q);
+    }
+  }
+  std::println("simd: {} with {} lanes, {} random hits agree",
+               simd::instruction_set, simd::width, hits);
+}
+
+void bench_simd(uint32 n) {
+  const grid mesh{n};
+  const auto surface = surface_from(mesh, n);
+
+  std::mt19937 rng{n};
+  std::uniform_real_distribution<float32> coordinate{0.0f, float32(n)};
+  std::vector<ray> rays(1 << 6);
+  for (auto& r : rays)
+    r = {{coordinate(rng), coordinate(rng), 20.0f}, {0.0f, 0.0f, -1.0f}};
+
+  size_t scalar_hits = 0;
+  const auto scalar = time_of(
+      [&] {
+        scalar_hits = 0;
+        for (const auto& r : rays)
+          scalar_hits += bool(scalar_intersection(r, surface));
+      },
+      1);
+  size_t packet_hits = 0;
+  const auto packet = time_of(
+      [&] {
+        packet_hits = 0;
+        for (const auto& r : rays)
+          packet_hits += bool(intersection(r, surface));
+      },
+      1);
+  if (scalar_hits != packet_hits)
+    throw std::runtime_error("Scalar and SIMD linear scans differ.");
+
+  std::println("linear scan: {} faces, {} rays", mesh.faces.size(),
+               rays.size());
+  std::println("  scalar {:10.2f} ns/face", 1e6 * scalar / rays.size() /
+                                                mesh.faces.size());
+  std::println("  SIMD   {:10.2f} ns/face", 1e6 * packet / rays.size() /
+                                                mesh.faces.size());
+}
+
+void bench_ray_batch(uint32 n) {
+  const grid mesh{n};
+  const auto surface = surface_from(mesh, n);
+  const auto tree = bvh_from(surface);
+
+  // Camera above the surface looking down on all of it.
+  //
+  ensketch::opengl::camera camera{};
+  camera.set_screen_resolution(1920, 1080)
+      .set_vfov(0.8f)
+      .move({0.5f * n, 0.5f * n, 1.5f * n})
+      .look_at({0.5f * n, 0.5f * n, 0.0f}, {0.0f, 1.0f, 0.0f});
+
+  // Long random stroke on the screen like a recorded mouse curve.
+  //
+  std::mt19937 rng{n};
+  std::normal_distribution<float32> step{0.0f, 4.0f};
+  std::vector<vec2> points(1 << 14);
+  vec2 p{960.0f, 540.0f};
+  for (auto& x : points) {
+    p = glm::clamp(p + vec2{step(rng), step(rng)}, vec2{0.0f},
+                   vec2{1919.0f, 1079.0f});
+    x = p;
+  }
+
+  std::vector<polyhedral_surface::vertex_id> sequential_vertices(
+      points.size());
+  const auto sequential = time_of([&] {
+    for (size_t i = 0; i < points.size(); ++i) {
+      const auto r = primary_ray(camera, points[i].x, points[i].y);
+      sequential_vertices[i] =
+          nearest_vertex(surface, intersection(r, surface, tree));
+    }
+  });
+  std::vector<screen_point_intersection> hits{};
+  const auto batch = time_of(
+      [&] { hits = intersections(camera, points, surface, tree); });
+
+  for (size_t i = 0; i < points.size(); ++i)
+    if (hits[i].vertex != sequential_vertices[i])
+      throw std::runtime_error("Batched and sequential ray casting differ.");
+
+  std::println("ray batch: {} faces, {} screen points, {} threads",
+               mesh.faces.size(), points.size(), thread_count());
+  std::println("  sequential {:10.2f} ms", sequential);
+  std::println("  batched    {:10.2f} ms", batch);
+}
+
+void bench_selection(uint32 n) {
+  const grid mesh{n};
+  const auto surface = surface_from(mesh, n);
+  const auto faces = bvh_from(surface);
+  const auto vertices = kd_tree_from(surface);
+
+  // Flat view onto the surface such that its waves occlude each other.
+  //
+  ensketch::opengl::camera camera{};
+  camera.set_screen_resolution(1920, 1080)
+      .set_vfov(0.8f)
+      .move({0.5f * n, -0.2f * n, 10.0f})
+      .look_at({0.5f * n, 0.5f * n, 0.0f}, {0.0f, 0.0f, 1.0f});
+
+  // Star-shaped lasso around the center of the screen.
+  //
+  std::vector<vec2> lasso(256);
+  for (size_t i = 0; i < lasso.size(); ++i) {
+    const auto phi = 2.0f * std::numbers::pi_v<float32> * i / lasso.size();
+    const auto r = 300.0f + 150.0f * std::sin(7.0f * phi);
+    lasso[i] = vec2{960.0f, 540.0f} + r * vec2{std::cos(phi), std::sin(phi)};
+  }
+  const auto regions = std::array{
+      screen_region_from(vec2{480.0f, 270.0f}, vec2{1440.0f, 810.0f}),
+      screen_region_from(lasso)};
+
+  // Compare with projecting every vertex and face centroid.
+  //
+  const auto brute_force = [&](const screen_region& region,
+                               bool occlusion) {
+    selection_mask result(surface.vertices.size());
+    for (uint32 i = 0; i < surface.vertices.size(); ++i) {
+      const auto& p = surface.vertices[i].position;
+      const auto q = screen_position(camera, p);
+      if (!q || !region.contains(*q)) continue;
+      if (occlusion) {
+        const auto l = distance(p, camera.position());
+        const auto hit = intersection(
+            ray{camera.position(), (p - camera.position()) / l}, surface,
+            faces);
+        if (hit && (hit.t < l * (1.0f - 1e-4f)) &&
+            (std::ranges::find(surface.faces[hit.f], i) ==
+             surface.faces[hit.f].end()))
+          continue;
+      }
+      result.set(i);
+    }
+    return result;
+  };
+
+  std::println("selection: {} vertices, {} faces, {} threads",
+               surface.vertices.size(), mesh.faces.size(), thread_count());
+  for (const auto& region : regions) {
+    const auto name = region.lasso.empty() ? "rectangle" : "lasso";
+    selection_mask selected{};
+    const auto linear = time_of([&] { selected = brute_force(region, false); });
+    const auto hierarchical = time_of([&] {
+      selected = select_vertices(camera, surface, vertices, region);
+    });
+    if (selected.words != brute_force(region, false).words)
+      throw std::runtime_error("Selected vertices are wrong.");
+    const auto visible = time_of([&] {
+      selected =
+          select_visible_vertices(camera, surface, vertices, faces, region);
+    });
+    if (selected.words != brute_force(region, true).words)
+      throw std::runtime_error("Selected visible vertices are wrong.");
+    const auto count = select_vertices(camera, surface, vertices, region)
+                           .count();
+    const auto face_selection = time_of(
+        [&] { selected = select_faces(camera, surface, faces, region); });
+    const auto face_count = selected.count();
+    std::println("  {:9} {} vertices, {} visible, {} faces", name, count,
+                 select_visible_vertices(camera, surface, vertices, faces,
+                                         region)
+                     .count(),
+                 face_count);
+    std::println("    linear vertices        {:10.2f} ms", linear);
+    std::println("    hierarchical vertices  {:10.2f} ms", hierarchical);
+    std::println("    visible vertices       {:10.2f} ms", visible);
+    std::println("    hierarchical faces     {:10.2f} ms", face_selection);
+  }
+}
+
+void bench_cpu_renderer(uint32 n) {
+  const grid mesh{n};
+  const auto surface = surface_from(mesh, n);
+  const auto tree = bvh_from(surface);
+
+  ensketch::opengl::camera camera{};
+  camera.set_screen_resolution(1920, 1080)
+      .set_vfov(0.8f)
+      .move({0.5f * n, -0.5f * n, 1.5f * n})
+      .look_at({0.5f * n, 0.5f * n, 0.0f}, {0.0f, 0.0f, 1.0f});
+
+  std::vector<float32> field(surface.vertices.size());
+  for (size_t i = 0; i < field.size(); ++i)
+    field[i] = surface.vertices[i].position.z;
+
+  // The surface has no vertex normals.
+  cpu_render_options options{};
+  options.use_face_normal = true;
+  rgb_image image{};
+  const auto shaded =
+      time_of([&] { image = render(camera, surface, tree, options); });
+  options.wireframe = true;
+  const auto wireframe = time_of(
+      [&] { image = render(camera, surface, tree, field, options); });
+
+  const auto fps = [](float64 ms) { return 1000.0 / ms; };
+  const auto threads = thread_count();
+  std::println("cpu_renderer: {} faces, {}x{} pixels, {} threads",
+               mesh.faces.size(), image.width, image.height, threads);
+  std::println("  shaded             {:10.2f} ms, {:8.3f} fps per thread",
+               shaded, fps(shaded) / threads);
+  std::println("  field + wireframe  {:10.2f} ms, {:8.3f} fps per thread",
+               wireframe, fps(wireframe) / threads);
+}
+
+void bench_spatial_index(uint32 n) {
+  const grid mesh{n};
+  const auto surface = surface_from(mesh, n);
+
+  kd_tree vertices{};
+  const auto kd_build = time_of([&] { vertices = kd_tree_from(surface); });
+  const auto faces = bvh_from(surface);
+
+  // Random queries in a slab around the surface.
+  //
+  std::mt19937 rng{n};
+  std::uniform_real_distribution<float32> coordinate{0.0f, float32(n)};
+  std::uniform_real_distribution<float32> height{-10.0f, 10.0f};
+  std::vector<vec3> queries(1 << 14);
+  for (auto& q : queries) q = {coordinate(rng), coordinate(rng), height(rng)};
+
+  // Compare a few queries with brute force.
+  //
+  constexpr size_t k = 8;
+  constexpr float32 radius = 3.0f;
+  std::vector<float32> distances(surface.vertices.size());
+  const auto brute_force = time_of(
+      [&] {
+        for (size_t i = 0; i < 16; ++i) {
+          const auto& q = queries[i];
+          for (size_t j = 0; j < distances.size(); ++j)
+            distances[j] = distance(q, surface.vertices[j].position);
+          auto sorted = distances;
+          std::ranges::sort(sorted);
+          const auto knn = nearest(vertices, q, k);
+          for (size_t j = 0; j < k; ++j)
+            if (knn[j].distance != sorted[j])
+              throw std::runtime_error("k-NN of kd-tree is wrong.");
+          const auto count = std::ranges::count_if(
+              distances, [&](float32 d) { return d <= radius; });
+          if (within(vertices, q, radius).size() != size_t(count))
+            throw std::runtime_error("Radius query of kd-tree is wrong.");
+
+          auto best = infinity;
+          for (const auto& f : surface.faces) {
+            const triangle t{surface.vertices[f[0]].position,
+                             surface.vertices[f[1]].position,
+                             surface.vertices[f[2]].position};
+            const auto x = closest_point(t, q);
+            best = std::min(
+                best,
+                distance(q, (1 - x.u - x.v) * t[0] + x.u * t[1] + x.v * t[2]));
+          }
+          if (closest_point(surface, faces, q).distance != best)
+            throw std::runtime_error("Closest point on surface is wrong.");
+        }
+      },
+      1);
+
+  const auto per_query = [&](auto&& f) {
+    return 1e3 * time_of([&] {
+             for (const auto& q : queries) f(q);
+           }) /
+           queries.size();
+  };
+  const auto nearest_latency =
+      per_query([&](const vec3& q) { nearest(vertices, q); });
+  const auto knn_latency =
+      per_query([&](const vec3& q) { nearest(vertices, q, k); });
+  const auto radius_latency =
+      per_query([&](const vec3& q) { within(vertices, q, radius); });
+  const auto closest_latency =
+      per_query([&](const vec3& q) { closest_point(surface, faces, q); });
+
+  const auto per_batch_query = [&](auto&& f) {
+    return 1e3 * time_of(f) / queries.size();
+  };
+  const auto knn_batch =
+      per_batch_query([&] { nearest(vertices, queries, k); });
+  const auto closest_batch =
+      per_batch_query([&] { closest_points(surface, faces, queries); });
+
+  std::println("spatial index: {} vertices, {} faces, {} threads",
+               surface.vertices.size(), mesh.faces.size(), thread_count());
+  std::println("  kd-tree build          {:10.2f} ms", kd_build);
+  std::println("  brute force            {:10.2f} us/query",
+               1e3 * brute_force / 16);
+  std::println("  nearest vertex         {:10.2f} us/query", nearest_latency);
+  std::println("  {} nearest vertices     {:10.2f} us/query", k, knn_latency);
+  std::println("  vertices in radius {}   {:10.2f} us/query", radius,
+               radius_latency);
+  std::println("  closest surface point  {:10.2f} us/query", closest_latency);
+  std::println("  batched {} nearest      {:10.2f} us/query", k, knn_batch);
+  std::println("  batched closest point  {:10.2f} us/query", closest_batch);
+}
+
+void bench_stl_stream(uint32 n) {
+  const grid mesh{n};
+  const auto path =
+      std::filesystem::temp_directory_path() / "ensketch-sandbox-bench.stl";
+
+  // Write the grid as binary STL file.
+  //
+  {
+    std::ofstream file{path, std::ios::binary};
+    const stl_surface::header header{};
+    const auto size = static_cast<stl_surface::size_type>(mesh.faces.size());
+    const stl_surface::attribute_byte_count_type attribute{};
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (const auto& f : mesh.faces) {
+      stl_surface::triangle t{};
+      for (int k = 0; k < 3; ++k)
+        t.vertex[k] = {f[k] / (n + 1), f[k] % (n + 1), (f[k] * f[k]) % 7};
+      file.write(reinterpret_cast<const char*>(&t), sizeof(t));
+      file.write(reinterpret_cast<const char*>(&attribute), sizeof(attribute));
+    }
+  }
+
+  aabb3 loaded{};
+  const auto load = time_of(
+      [&] {
+        const stl_surface data{path};
+        loaded = aabb3{data.triangles.front().vertex[0]};
+        for (const auto& t : data.triangles)
+          for (const auto& v : t.vertex) loaded = aabb3{loaded, v};
+      },
+      1);
+  const stl_stream_options options{};
+  aabb3 streamed{};
+  const auto stream =
+      time_of([&] { streamed = aabb_from_stl_file(path, options); }, 1);
+  std::filesystem::remove(path);
+
+  if ((loaded._min != streamed._min) || (loaded._max != streamed._max))
+    throw std::runtime_error("Bounding boxes of loaded and streamed differ.");
+
+  const auto mib = [](size_t bytes) { return bytes / float64(1 << 20); };
+  std::println("stl_stream: {} faces, {} threads", mesh.faces.size(),
+               thread_count());
+  std::println("  load + bounding box   {:10.2f} ms, {:8.2f} MiB triangles",
+               load, mib(mesh.faces.size() * sizeof(stl_surface::triangle)));
+  std::println("  streamed bounding box {:10.2f} ms, {:8.2f} MiB budget",
+               stream, mib(options.memory_budget));
+}
+
+// Measurements of all meshes in a machine-readable form. Every mesh adds
+// an object with flat numeric fields to the array `results` such that runs
+// can be compared automatically to catch regressions.
+//
+struct json_report {
+  struct entry {
+    // JSON has no representation of infinite or NaN values.
+    void set(std::string_view key, float64 value) {
+      if (std::isfinite(value))
+        fields.push_back(std::format("\"{}\": {}", key, value));
+      else
+        fields.push_back(std::format("\"{}\": null", key));
+    }
+    void set(std::string_view key, std::string_view value) {
+      std::string escaped{};
+      for (auto c : value) {
+        if ((c == '"') || (c == '\\')) escaped += '\\';
+        escaped += c;
+      }
+      fields.push_back(std::format("\"{}\": \"{}\"", key, escaped));
+    }
+
+    std::vector<std::string> fields{};
+  };
+
+  auto add() -> entry& { return entries.emplace_back(); }
+
+  void write(const std::filesystem::path& path) const {
+    std::ofstream file{path};
+    if (!file)
+      throw std::runtime_error(std::format(
+          "Failed to open file '{}' for the benchmark report.", path.string()));
+    std::println(file, "{{\n  \"threads\": {},\n  \"results\": [",
+                 thread_count());
+    for (size_t i = 0; i < entries.size(); ++i) {
+      std::println(file, "    {{");
+      const auto& fields = entries[i].fields;
+      for (size_t j = 0; j < fields.size(); ++j)
+        std::println(file, "      {}{}", fields[j],
+                     (j + 1 < fields.size()) ? "," : "");
+      std::println(file, "    }}{}", (i + 1 < entries.size()) ? "," : "");
+    }
+    std::println(file, "  ]\n}}");
+  }
+
+  std::deque<entry> entries{};
+};
+
+// Triangle soup of an STL file. Welding is not needed for ray casting.
+//
+auto surface_from(const stl_surface& data) -> polyhedral_surface {
+  polyhedral_surface surface{};
+  surface.vertices.resize(3 * data.triangles.size());
+  surface.faces.resize(data.triangles.size());
+  for (uint32 i = 0; i < data.triangles.size(); ++i) {
+    for (uint32 j = 0; j < 3; ++j)
+      surface.vertices[3 * i + j] = {.position = data.triangles[i].vertex[j],
+                                     .normal = data.triangles[i].normal};
+    surface.faces[i] = {3 * i + 0, 3 * i + 1, 3 * i + 2};
+  }
+  return surface;
+}
+
+// Time ray casting and picking on a surface with a camera that looks at the
+// whole surface like the viewer after loading it. Linear scans are slow for
+// large meshes. So, only a few of the rays are used for them.
+//
+void bench_ray_tracing(std::string_view name,
+                       const polyhedral_surface& surface,
+                       json_report& report) {
+  // Cameras cannot look at surfaces without any extent.
+  //
+  aabb3 box{};
+  if (!surface.faces.empty()) {
+    box = aabb3{surface.vertices.front().position};
+    for (const auto& v : surface.vertices) box = aabb3{box, v.position};
+  }
+  if (surface.faces.empty() || !(box.radius() > 0)) {
+    std::println("ray tracing: {}, skipped empty or degenerate surface", name);
+    return;
+  }
+  ensketch::opengl::camera camera{};
+  camera.set_screen_resolution(1920, 1080);
+  const auto radius = box.radius() / std::tan(0.5f * camera.vfov());
+  camera.move(box.origin() + vec3{0.0f, 0.0f, radius})
+      .look_at(box.origin(), {0.0f, 1.0f, 0.0f})
+      .set_near_and_far(1e-4f * radius, 2 * radius);
+
+  std::mt19937 rng{surface.faces.size()};
+  std::uniform_real_distribution<float32> x{0.0f, 1920.0f};
+  std::uniform_real_distribution<float32> y{0.0f, 1080.0f};
+  std::vector<vec2> points(1 << 14);
+  for (auto& p : points) p = {x(rng), y(rng)};
+  std::vector<ray> rays(points.size());
+  for (size_t i = 0; i < points.size(); ++i)
+    rays[i] = primary_ray(camera, points[i].x, points[i].y);
+
+  bvh tree{};
+  const auto bvh_build = time_of([&] { tree = bvh_from(surface); });
+  kd_tree vertices{};
+  const auto kd_build = time_of([&] { vertices = kd_tree_from(surface); });
+
+  constexpr size_t linear_rays = 64;
+  std::vector<ray_polyhedral_surface_intersection> hits(rays.size());
+  const auto linear = time_of(
+      [&] {
+        for (size_t i = 0; i < linear_rays; ++i)
+          hits[i] = intersection(rays[i], surface);
+      },
+      1);
+  for (size_t i = 0; i < linear_rays; ++i) {
+    const auto hit = intersection(rays[i], surface, tree);
+    if ((hit.f != hits[i].f) || (hit.t != hits[i].t))
+      throw std::runtime_error("Intersections of BVH and linear scan differ.");
+  }
+  const auto traversal = time_of([&] {
+    for (size_t i = 0; i < rays.size(); ++i)
+      hits[i] = intersection(rays[i], surface, tree);
+  });
+  const auto hit_count =
+      std::ranges::count_if(hits, [](const auto& h) { return bool(h); });
+  const auto hit_ratio = float64(hit_count) / hits.size();
+
+  // Single picks like `viewer::surface_vertex_from`.
+  //
+  std::vector<polyhedral_surface::vertex_id> picks(points.size());
+  const auto picking = time_of([&] {
+    for (size_t i = 0; i < points.size(); ++i) {
+      const auto r = primary_ray(camera, points[i].x, points[i].y);
+      picks[i] = nearest_vertex(surface, intersection(r, surface, tree));
+    }
+  });
+  std::vector<screen_point_intersection> projection{};
+  const auto batch = time_of(
+      [&] { projection = intersections(camera, points, surface, tree); });
+  for (size_t i = 0; i < points.size(); ++i)
+    if (projection[i].vertex != picks[i])
+      throw std::runtime_error("Batched and single picks differ.");
+
+  const auto per_second = [](size_t count, float64 ms) {
+    return 1e3 * count / ms;
+  };
+  const auto linear_rate = per_second(linear_rays, linear);
+  const auto traversal_rate = per_second(rays.size(), traversal);
+  const auto picking_rate = per_second(points.size(), picking);
+  const auto batch_rate = per_second(points.size(), batch);
+  const auto bvh_rate = per_second(surface.faces.size(), bvh_build);
+  const auto kd_rate = per_second(surface.vertices.size(), kd_build);
+
+  std::println("ray tracing: {}, {} vertices, {} faces, {} threads", name,
+               surface.vertices.size(), surface.faces.size(), thread_count());
+  std::println("  bvh build         {:10.2f} ms, {:8.2f} M faces/s", bvh_build,
+               1e-6 * bvh_rate);
+  std::println("  kd-tree build     {:10.2f} ms, {:8.2f} M vertices/s",
+               kd_build, 1e-6 * kd_rate);
+  std::println("  linear scan       {:10.2f} k rays/s", 1e-3 * linear_rate);
+  std::println("  bvh traversal     {:10.2f} M rays/s", 1e-6 * traversal_rate);
+  std::println("  single picks      {:10.2f} M picks/s", 1e-6 * picking_rate);
+  std::println("  batch projection  {:10.2f} M rays/s", 1e-6 * batch_rate);
+
+  auto& result = report.add();
+  result.set("mesh", name);
+  result.set("vertices", surface.vertices.size());
+  result.set("faces", surface.faces.size());
+  result.set("hit_ratio", hit_ratio);
+  result.set("bvh_nodes", tree.nodes.size());
+  result.set("bvh_build_ms", bvh_build);
+  result.set("bvh_build_faces_per_s", bvh_rate);
+  result.set("kd_tree_build_ms", kd_build);
+  result.set("kd_tree_build_vertices_per_s", kd_rate);
+  result.set("linear_rays_per_s", linear_rate);
+  result.set("bvh_rays_per_s", traversal_rate);
+  result.set("picks_per_s", picking_rate);
+  result.set("batch_rays_per_s", batch_rate);
+}
+
+}  // namespace
+
+void bench_segmentation(uint32 n) {
+  auto surface = surface_from(grid{n}, n);
+  surface.generate_edges();
+  const auto id = [n](uint32 i, uint32 j) { return i * (n + 1) + j; };
+
+  // Network of three rows and three columns that cut the grid
+  // into 16 regions and a closed square in the center.
+  //
+  std::vector<std::vector<uint32>> lines(6);
+  for (uint32 k = 1; k < 4; ++k) {
+    for (uint32 j = 0; j <= n; ++j) {
+      lines[2 * k - 2].push_back(id(k * n / 4, j));
+      lines[2 * k - 1].push_back(id(j, k * n / 4));
+    }
+  }
+  std::vector<vertex_curve> network{};
+  for (const auto& line : lines) network.push_back({line});
+  std::vector<uint32> square{};
+  for (uint32 j = n / 8; j < 7 * n / 8; ++j) square.push_back(id(n / 8, j));
+  for (uint32 i = n / 8; i < 7 * n / 8; ++i)
+    square.push_back(id(i, 7 * n / 8));
+  for (uint32 j = 7 * n / 8; j > n / 8; --j)
+    square.push_back(id(7 * n / 8, j));
+  for (uint32 i = 7 * n / 8; i > n / 8; --i) square.push_back(id(i, n / 8));
+
+  // Baseline: Serial flood fill over the faces in face order.
+  //
+  const auto& c = surface.connectivity;
+  std::vector<bool> cut(c.halfedge_count());
+  for (const auto& line : lines) {
+    for (size_t i = 1; i < line.size(); ++i) {
+      cut[c.halfedge(line[i - 1], line[i])] = true;
+      cut[c.halfedge(line[i], line[i - 1])] = true;
+    }
+  }
+  std::vector<uint32> serial_regions{};
+  uint32 serial_count = 0;
+  const auto serial = time_of([&] {
+    serial_regions.assign(surface.faces.size(), -1);
+    serial_count = 0;
+    std::vector<uint32> stack{};
+    for (uint32 f = 0; f < surface.faces.size(); ++f) {
+      if (serial_regions[f] != uint32(-1)) continue;
+      serial_regions[f] = serial_count;
+      stack.push_back(f);
+      while (!stack.empty()) {
+        const auto g = stack.back();
+        stack.pop_back();
+        for (uint32 h = 3 * g; h < 3 * g + 3; ++h) {
+          const auto x = c.opposite_face(h);
+          if (cut[h] || (x == uint32(-1)) || (serial_regions[x] != uint32(-1)))
+            continue;
+          serial_regions[x] = serial_count;
+          stack.push_back(x);
+        }
+      }
+      ++serial_count;
+    }
+  });
+
+  surface_segmentation segmentation{};
+  const auto parallel = time_of(
+      [&] { segmentation = surface_segmentation_from(surface, network); });
+  if ((segmentation.region_count() != 16) ||
+      (segmentation.region_count() != serial_count) ||
+      (segmentation.regions != serial_regions))
+    throw std::runtime_error("Serial and parallel segmentation differ.");
+
+  std::vector<int8> sides{};
+  const auto bipartition =
+      time_of([&] { sides = bipartition_from(surface, square, true); });
+  const auto inside = std::ranges::count(sides, int8(1));
+  const auto outside = std::ranges::count(sides, int8(-1));
+  const auto m = 7 * n / 8 - n / 8;
+  if (((inside != 2 * m * m) && (outside != 2 * m * m)) ||
+      (inside + outside != sides.size()))
+    throw std::runtime_error("Bi-partition of square is wrong.");
+
+  std::println("segmentation: {} faces, {} regions, {} threads",
+               surface.faces.size(), segmentation.region_count(),
+               thread_count());
+  std::println("  serial flood fill   {:10.2f} ms", serial);
+  std::println("  parallel union-find {:10.2f} ms", parallel);
+  std::println("  bi-partition        {:10.2f} ms", bipartition);
+}
+
+void bench_ambient_occlusion(uint32 n) {
+  const grid mesh{n};
+  auto surface = surface_from(mesh, n);
+  // Normals of the height field that the grid is sampled from.
+  for (uint32 i = 0; i <= n; ++i)
+    for (uint32 j = 0; j <= n; ++j)
+      surface.vertices[i * (n + 1) + j].normal = normalize(
+          vec3{-0.5f * std::cos(0.1f * i) * std::cos(0.1f * j),
+               0.5f * std::sin(0.1f * i) * std::sin(0.1f * j), 1.0f});
+  const auto tree = bvh_from(surface);
+
+  // The any-hit query must agree with the closest hit.
+  //
+  std::mt19937 rng{n};
+  std::uniform_real_distribution<float32> coordinate{0.0f, float32(n)};
+  std::uniform_real_distribution<float32> tilt{-1.0f, 1.0f};
+  std::uniform_real_distribution<float32> distance{0.0f, 40.0f};
+  for (int k = 0; k < (1 << 12); ++k) {
+    const ray r{{coordinate(rng), coordinate(rng), 10.0f},
+                normalize(vec3{tilt(rng), tilt(rng), -0.5f})};
+    const auto t_max = distance(rng);
+    const auto hit = intersection(r, surface, tree);
+    if (occluded(r, surface, tree, t_max) != (hit && (hit.t < t_max)))
+      throw std::runtime_error("Occlusion query and closest hit differ.");
+  }
+
+  const ambient_occlusion_options options{.samples = 16,
+                                          .samples_per_pass = 8,
+                                          .max_distance = 10.0f};
+  std::vector<float32> values{};
+  const auto bake = time_of(
+      [&] { values = ambient_occlusion_from(surface, tree, options); }, 1);
+  const auto rays = float64(options.samples) * surface.vertices.size();
+  float64 mean = 0;
+  for (auto x : values) mean += x;
+  mean /= values.size();
+
+  std::println("ambient occlusion: {} vertices, {} rays/vertex, {} threads",
+               surface.vertices.size(), options.samples, thread_count());
+  std::println("  bake       {:10.2f} ms", bake);
+  std::println("  throughput {:10.2f} M rays/s", 1e-3 * rays / bake);
+  std::println("  mean value {:10.4f}", mean);
+}
+
+void bench_reordering(uint32 n) {
+  // Randomly shuffled vertices and faces as worst case
+  // of meshes whose order has been destroyed by processing.
+  //
+  const grid mesh{n};
+  auto surface = surface_from(mesh, n);
+  std::mt19937 rng{n};
+  std::vector<uint32> shuffle(surface.vertices.size());
+  std::iota(shuffle.begin(), shuffle.end(), 0);
+  std::ranges::shuffle(shuffle, rng);
+  const auto scrambled = permutation_from(shuffle);
+  {
+    auto vertices = surface.vertices;
+    for (size_t v = 0; v < vertices.size(); ++v)
+      surface.vertices[v] = vertices[scrambled.order[v]];
+    for (auto& f : surface.faces)
+      for (auto& v : f) v = scrambled.map[v];
+    std::ranges::shuffle(surface.faces, rng);
+  }
+  surface.generate_edges();
+  const auto shuffled_edges = time_of([&] { surface.generate_edges(); });
+
+  const auto old_vertices = surface.vertices;
+  const auto old_faces = surface.faces;
+  mesh_reordering reordering{};
+  const auto reorder_time =
+      time_of([&] { reordering = reorder(surface); }, 1);
+  const auto reordered_edges = time_of([&] { surface.generate_edges(); });
+
+  // Both permutations have to be inverse to each other
+  // and have to map old elements to the new ones.
+  //
+  const auto& vertices = reordering.vertices;
+  const auto& faces = reordering.faces;
+  for (size_t v = 0; v < vertices.size(); ++v)
+    if ((vertices.map[vertices.order[v]] != v) ||
+        (surface.vertices[v].position !=
+         old_vertices[vertices.order[v]].position))
+      throw std::runtime_error("Vertex permutation is invalid.");
+  for (size_t f = 0; f < faces.size(); ++f) {
+    if (faces.map[faces.order[f]] != f)
+      throw std::runtime_error("Face permutation is invalid.");
+    for (size_t k = 0; k < 3; ++k)
+      if (surface.faces[f][k] != vertices.map[old_faces[faces.order[f]][k]])
+        throw std::runtime_error("Faces have not been remapped.");
+  }
+
+  std::println("mesh reordering: {} faces, {} threads", surface.faces.size(),
+               thread_count());
+  std::println("  reorder                 {:10.2f} ms", reorder_time);
+  std::println("  ACMR before             {:10.3f}", reordering.acmr_before);
+  std::println("  ACMR after              {:10.3f}", reordering.acmr_after);
+  std::println("  generate edges shuffled {:10.2f} ms", shuffled_edges);
+  std::println("  generate edges ordered  {:10.2f} ms", reordered_edges);
+}
+
+void bench_quantized_vertices(uint32 n) {
+  const grid mesh{n};
+  auto surface = surface_from(mesh, n);
+  std::mt19937 rng{n};
+  std::normal_distribution<float32> normal{};
+  for (auto& v : surface.vertices)
+    v.normal = normalize(vec3{normal(rng), normal(rng), normal(rng)});
+
+  quantized_vertices data{};
+  const auto encode =
+      time_of([&] { data = quantized_vertices_from(surface.vertices); });
+
+  // Decoding on the fly has to stay inside the quantization error.
+  //
+  float32 position_error = 0;
+  float32 normal_error = 0;
+  vec3 sum{};
+  const auto extent = data.extent();
+  const auto decode = time_of([&] {
+    sum = {};
+    for (size_t i = 0; i < data.size(); ++i)
+      sum += data.position(i) + data.normal(i);
+  });
+  for (size_t i = 0; i < data.size(); ++i) {
+    const auto d = data.position(i) - surface.vertices[i].position;
+    for (int k = 0; k < 3; ++k)
+      if (extent[k] > 0)
+        position_error = std::max(position_error, std::abs(d[k]) / extent[k]);
+    normal_error = std::max(
+        normal_error,
+        std::acos(std::min(
+            dot(data.normal(i), surface.vertices[i].normal), 1.0f)));
+  }
+  if ((position_error > 1e-5f) || (normal_error > 1e-3f))
+    throw std::runtime_error("Quantization error is too large.");
+
+  const auto bytes = [](size_t x) { return float64(x) / (1 << 20); };
+  std::println("quantized vertices: {} vertices, {} threads", data.size(),
+               thread_count());
+  std::println("  full size        {:10.2f} MiB",
+               bytes(surface.vertices.size() * sizeof(surface.vertices[0])));
+  std::println("  compact size     {:10.2f} MiB",
+               bytes(data.size() * sizeof(quantized_vertex)));
+  std::println("  encode           {:10.2f} ms", encode);
+  std::println("  decode           {:10.2f} ns/vertex (checksum {})",
+               1e6 * decode / data.size(), sum.x + sum.y + sum.z);
+  std::println("  position error   {:10.2e} of extent", position_error);
+  std::println("  normal error     {:10.4f} degrees",
+               normal_error * 180 / std::numbers::pi);
+}
+
+void bench_decimation(uint32 n) {
+  // Closed torus with 2 n^2 faces such that decimation has
+  // to preserve its topology and its geometry is known.
+  //
+  constexpr float32 major = 3.0f;
+  constexpr float32 minor = 1.0f;
+  polyhedral_surface surface{};
+  const auto id = [n](uint32 i, uint32 j) { return (i % n) * n + (j % n); };
+  surface.vertices.resize(size_t(n) * n);
+  for (uint32 i = 0; i < n; ++i) {
+    for (uint32 j = 0; j < n; ++j) {
+      const auto u = 2 * std::numbers::pi_v<float32> * i / n;
+      const auto v = 2 * std::numbers::pi_v<float32> * j / n;
+      const vec3 normal{std::cos(u) * std::cos(v), std::sin(u) * std::cos(v),
+                        std::sin(v)};
+      surface.vertices[id(i, j)] = {
+          vec3{major * std::cos(u), major * std::sin(u), 0.0f} +
+              minor * normal,
+          normal};
+      surface.faces.push_back({id(i, j), id(i + 1, j), id(i + 1, j + 1)});
+      surface.faces.push_back({id(i, j), id(i + 1, j + 1), id(i, j + 1)});
+    }
+  }
+
+  std::vector<surface_lod> lods{};
+  const decimation_options options{.ratio = 0.25f, .min_face_count = 1000};
+  const auto build =
+      time_of([&] { lods = surface_lods_from(surface, options); }, 1);
+
+  std::println("decimation: {} faces, {} threads", surface.faces.size(),
+               thread_count());
+  std::println("  LOD chain        {:10.2f} ms", build);
+  for (const auto& lod : lods) {
+    const auto& s = lod.surface;
+    // Both maps have to be consistent and every vertex
+    // has to be collapsed into one of the LOD.
+    //
+    for (uint32 v = 0; v < s.vertices.size(); ++v)
+      if (lod.vertex_map[lod.origins[v]] != v)
+        throw std::runtime_error("LOD origins are inconsistent.");
+    for (auto v : lod.vertex_map)
+      if (v >= s.vertices.size())
+        throw std::runtime_error("LOD vertex map is out of range.");
+
+    // The torus has to stay closed and manifold.
+    //
+    for (uint32 h = 0; h < s.connectivity.halfedge_count(); ++h)
+      if (s.connectivity.twin(h) == halfedge_connectivity::invalid)
+        throw std::runtime_error("LOD has boundary edges.");
+    for (uint32 v = 0; v < s.vertices.size(); ++v) {
+      const auto targets = s.connectivity.targets_of(v);
+      if (std::ranges::adjacent_find(targets) != targets.end())
+        throw std::runtime_error("LOD has non-manifold edges.");
+    }
+    const auto euler = int64(s.vertices.size()) - int64(s.faces.size()) / 2;
+    if (euler != 0) throw std::runtime_error("LOD changed the topology.");
+
+    float32 error = 0;
+    for (const auto& x : s.vertices) {
+      const auto& p = x.position;
+      const auto r = std::sqrt(p.x * p.x + p.y * p.y) - major;
+      error = std::max(error, std::abs(std::sqrt(r * r + p.z * p.z) - minor));
+    }
+    std::println("  {:10} faces  {:10.2e} max distance", s.faces.size(),
+                 error / minor);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  // Grid sizes and STL files are given as command-line arguments.
+  // The option `--json <file>` additionally writes the measurements
+  // of ray tracing and picking as JSON report.
+  //
+  std::vector<uint32> sizes{};
+  std::vector<std::filesystem::path> files{};
+  std::filesystem::path report_path{};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg == "--json") {
+      if (++i == argc) {
+        std::println(stderr, "Missing file path for option '--json'.");
+        return 1;
+      }
+      report_path = argv[i];
+    } else if (std::ranges::all_of(arg, [](char c) { return std::isdigit(c); }))
+      sizes.push_back(std::stoul(argv[i]));
+    else
+      files.push_back(arg);
+  }
+  // 1M and 10M faces by default.
+  if (sizes.empty() && files.empty()) sizes = {708, 2237};
+
+  json_report report{};
+  check_simd_kernels();
+  for (auto n : sizes) {
+    bench_halfedge_connectivity(n);
+    bench_generate_edges(n);
+    bench_one_rings(n);
+    bench_stl_stream(n);
+    bench_bvh(n);
+    bench_refit(n);
+    bench_spatial_index(n);
+    bench_simd(n);
+    bench_ray_batch(n);
+    bench_selection(n);
+    bench_cpu_renderer(n);
+    bench_segmentation(n);
+    bench_ambient_occlusion(n);
+    bench_reordering(n);
+    bench_quantized_vertices(n);
+    bench_decimation(n);
+    bench_ray_tracing(std::format("grid {}", n), surface_from(grid{n}, n),
+                      report);
+  }
+  for (const auto& path : files)
+    bench_ray_tracing(path.string(), surface_from(stl_surface{path}), report);
+  if (!report_path.empty()) report.write(report_path);
+}
@@ -124,5 +124,6 @@ using vertex_buffer = buffer<GL_ARRAY_BUFFER>;
 using element_buffer = buffer<GL_ELEMENT_ARRAY_BUFFER>;
 using uniform_buffer = buffer<GL_UNIFORM_BUFFER>;
 using shader_storage_buffer = buffer<GL_SHADER_STORAGE_BUFFER>;
+using pixel_pack_buffer = buffer<GL_PIXEL_PACK_BUFFER>;
 
 }  // namespace ensketch::opengl
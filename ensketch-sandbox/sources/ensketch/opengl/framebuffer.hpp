@@ -0,0 +1,93 @@
+#pragma once
+#include <ensketch/opengl/utility.hpp>
+
+namespace ensketch::opengl {
+
+struct renderbuffer_handle : object_handle {
+  using base = object_handle;
+  using base::base;
+
+  bool valid() const noexcept { return glIsRenderbuffer(handle) == GL_TRUE; }
+
+  operator bool() const noexcept { return valid(); }
+
+  void bind() const noexcept { glBindRenderbuffer(GL_RENDERBUFFER, handle); }
+
+  static void unbind() noexcept { glBindRenderbuffer(GL_RENDERBUFFER, 0); }
+
+  void allocate(GLenum format, GLsizei width, GLsizei height) const noexcept {
+    glNamedRenderbufferStorage(handle, format, width, height);
+  }
+};
+
+class renderbuffer final : public renderbuffer_handle {
+  using base = renderbuffer_handle;
+
+ public:
+  renderbuffer() noexcept { glCreateRenderbuffers(1, &handle); }
+
+  ~renderbuffer() noexcept { glDeleteRenderbuffers(1, &handle); }
+
+  // Copying is NOT allowed.
+  //
+  renderbuffer(const renderbuffer&) = delete;
+  renderbuffer& operator=(const renderbuffer&) = delete;
+
+  // Moving is allowed.
+  //
+  renderbuffer(renderbuffer&& x) : base{x.handle} { x.handle = 0; }
+  renderbuffer& operator=(renderbuffer&& x) {
+    swap(handle, x.handle);
+    return *this;
+  }
+};
+
+struct framebuffer_handle : object_handle {
+  using base = object_handle;
+  using base::base;
+
+  bool valid() const noexcept { return glIsFramebuffer(handle) == GL_TRUE; }
+
+  operator bool() const noexcept { return valid(); }
+
+  void bind() const noexcept { glBindFramebuffer(GL_FRAMEBUFFER, handle); }
+
+  // Binds the default framebuffer of the window.
+  //
+  static void unbind() noexcept { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+
+  void attach(GLenum attachment,
+              const renderbuffer_handle& buffer) const noexcept {
+    glNamedFramebufferRenderbuffer(handle, attachment, GL_RENDERBUFFER,
+                                   buffer.id());
+  }
+
+  bool complete() const noexcept {
+    return glCheckNamedFramebufferStatus(handle, GL_FRAMEBUFFER) ==
+           GL_FRAMEBUFFER_COMPLETE;
+  }
+};
+
+class framebuffer final : public framebuffer_handle {
+  using base = framebuffer_handle;
+
+ public:
+  framebuffer() noexcept { glCreateFramebuffers(1, &handle); }
+
+  ~framebuffer() noexcept { glDeleteFramebuffers(1, &handle); }
+
+  // Copying is NOT allowed.
+  //
+  framebuffer(const framebuffer&) = delete;
+  framebuffer& operator=(const framebuffer&) = delete;
+
+  // Moving is allowed.
+  //
+  framebuffer(framebuffer&& x) : base{x.handle} { x.handle = 0; }
+  framebuffer& operator=(framebuffer&& x) {
+    swap(handle, x.handle);
+    return *this;
+  }
+};
+
+}  // namespace ensketch::opengl
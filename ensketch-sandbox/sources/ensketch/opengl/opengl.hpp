@@ -1,4 +1,5 @@
 #include <ensketch/opengl/buffer.hpp>
 #include <ensketch/opengl/camera.hpp>
+#include <ensketch/opengl/framebuffer.hpp>
 #include <ensketch/opengl/shader_program.hpp>
 #include <ensketch/opengl/vertex_array.hpp>
@@ -0,0 +1,110 @@
+#include <ensketch/sandbox/ambient_occlusion.hpp>
+//
+#include <numbers>
+//
+#include <ensketch/sandbox/parallel.hpp>
+#include <ensketch/sandbox/ray_tracer.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+// Point `i` of the two-dimensional R2 sequence, which is based on
+// the plastic number, shifted by `x` modulo one.
+//
+auto r2_sample(uint32 i, const vec2& x) noexcept -> vec2 {
+  constexpr float64 a1 = 0.7548776662466927;
+  constexpr float64 a2 = 0.5698402909980532;
+  return vec2{float32(std::fmod(0.5 + a1 * i + x.x, 1.0)),
+              float32(std::fmod(0.5 + a2 * i + x.y, 1.0))};
+}
+
+// Pseudo-random rotation of the sample sequence for every vertex.
+//
+auto rotation_of(uint32 vid) noexcept -> vec2 {
+  auto x = vid * 0x9e3779b9u;
+  x ^= x >> 16;
+  x *= 0x85ebca6bu;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35u;
+  x ^= x >> 16;
+  return vec2{float32(x & 0xffff), float32(x >> 16)} / 65536.0f;
+}
+
+// Map a point of the unit square to a direction in the hemisphere
+// around the z-axis whose density is proportional to the cosine.
+//
+auto cosine_weighted(const vec2& u) noexcept -> vec3 {
+  const auto r = std::sqrt(u.x);
+  const auto phi = 2 * std::numbers::pi_v<float32> * u.y;
+  return {r * std::cos(phi), r * std::sin(phi),
+          std::sqrt(std::max(0.0f, 1.0f - u.x))};
+}
+
+// Orthonormal basis with the given unit vector as third axis.
+// See Duff et al., 'Building an Orthonormal Basis, Revisited'.
+//
+auto basis_from(const vec3& n) noexcept -> array<vec3, 3> {
+  const auto sign = std::copysign(1.0f, n.z);
+  const auto a = -1.0f / (sign + n.z);
+  const auto b = n.x * n.y * a;
+  return {vec3{1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x},
+          vec3{b, sign + n.y * n.y * a, -n.y}, n};
+}
+
+}  // namespace
+
+ambient_occlusion_bake::ambient_occlusion_bake(
+    const polyhedral_surface& s,
+    const bvh& t,
+    const ambient_occlusion_options& o)
+    : surface{s}, tree{t}, options{o} {
+  // The root of the BVH bounds all faces of the surface.
+  const auto radius = tree.empty() ? 0.0f : tree.root().box.radius();
+  if (options.max_distance <= 0) options.max_distance = 0.25f * radius;
+  options.samples_per_pass = std::max(options.samples_per_pass, 1u);
+  offset = 1e-5f * radius;
+  unoccluded.assign(surface.vertices.size(), 0);
+  visibility.assign(surface.vertices.size(), 1.0f);
+}
+
+void ambient_occlusion_bake::refine() {
+  if (done()) return;
+  const auto first = samples;
+  const auto last = std::min(samples + options.samples_per_pass,
+                             options.samples);
+  parallel_for(
+      surface.vertices.size(),
+      [&](size_t vid) {
+        const auto& [position, normal] = surface.vertices[vid];
+        const auto l = length(normal);
+        // Vertices without normal are not part of any proper face.
+        if (!(l > 0.0f)) return;
+        const auto n = normal / l;
+        const auto frame = basis_from(n);
+        const auto origin = position + offset * n;
+        const auto rotation = rotation_of(uint32(vid));
+        auto count = unoccluded[vid];
+        for (auto i = first; i < last; ++i) {
+          const auto d = cosine_weighted(r2_sample(i, rotation));
+          const ray r{origin, d.x * frame[0] + d.y * frame[1] + d.z * frame[2]};
+          if (!occluded(r, surface, tree, options.max_distance)) ++count;
+        }
+        unoccluded[vid] = count;
+        visibility[vid] = float32(count) / last;
+      },
+      // Every vertex casts a whole pass of rays.
+      size_t{64});
+  samples = last;
+}
+
+auto ambient_occlusion_from(const polyhedral_surface& surface,
+                            const bvh& tree,
+                            const ambient_occlusion_options& options)
+    -> vector<float32> {
+  ambient_occlusion_bake bake{surface, tree, options};
+  while (!bake.done()) bake.refine();
+  return {bake.values().begin(), bake.values().end()};
+}
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,77 @@
+#pragma once
+#include <ensketch/sandbox/bvh.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+
+namespace ensketch::sandbox {
+
+struct ambient_occlusion_options {
+  /// Number of hemisphere rays per vertex after the last pass.
+  ///
+  uint32 samples = 64;
+
+  /// Number of rays per vertex that are added by every pass.
+  ///
+  uint32 samples_per_pass = 8;
+
+  /// Occluders farther away from a vertex are ignored. Non-positive values
+  /// select a quarter of the radius of the bounding box of all faces.
+  ///
+  float32 max_distance = 0;
+};
+
+/// Progressive bake of per-vertex ambient occlusion on the CPU.
+/// For every vertex, rays are cast into the hemisphere around its normal
+/// with cosine-weighted directions and tested against the BVH of the
+/// surface's faces. The value of a vertex is the fraction of rays that
+/// are not occluded. So, one means no occlusion at all. Every call to
+/// `refine` adds a pass of rays for all vertices in parallel and leaves
+/// a complete estimate. Hence, intermediate results can already be shown.
+/// The directions of each vertex follow a low-discrepancy sequence with
+/// a per-vertex rotation. So, results are deterministic and the estimates
+/// of neighboring vertices do not show the same banding.
+///
+/// The surface and the BVH are referenced and must outlive the bake.
+///
+class ambient_occlusion_bake {
+ public:
+  ambient_occlusion_bake(const polyhedral_surface& surface,
+                         const bvh& tree,
+                         const ambient_occlusion_options& options = {});
+
+  /// Cast the rays of the next pass and update the estimate.
+  /// Does nothing when the bake is done.
+  ///
+  void refine();
+
+  bool done() const noexcept { return samples >= options.samples; }
+
+  /// Number of rays that have been cast per vertex so far.
+  ///
+  auto sample_count() const noexcept -> uint32 { return samples; }
+
+  /// Current estimate with one value in [0, 1] per vertex.
+  ///
+  auto values() const noexcept -> std::span<const float32> {
+    return visibility;
+  }
+
+ private:
+  const polyhedral_surface& surface;
+  const bvh& tree;
+  ambient_occlusion_options options;
+  // Rays start slightly above the surface to not hit their own faces.
+  float32 offset{};
+  uint32 samples = 0;
+  vector<uint32> unoccluded{};
+  vector<float32> visibility{};
+};
+
+/// Bake the ambient occlusion of all vertices with all passes at once.
+/// See `ambient_occlusion_bake`.
+///
+auto ambient_occlusion_from(const polyhedral_surface& surface,
+                            const bvh& tree,
+                            const ambient_occlusion_options& options = {})
+    -> vector<float32>;
+
+}  // namespace ensketch::sandbox
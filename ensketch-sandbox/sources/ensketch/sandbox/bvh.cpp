@@ -0,0 +1,325 @@
+#include <ensketch/sandbox/bvh.hpp>
+//
+#include <ensketch/sandbox/parallel.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+constexpr size_t bin_count = 16;
+constexpr size_t max_leaf_size = 4;
+// Nodes with fewer primitives are processed by a single thread.
+constexpr size_t parallel_threshold = size_t{1} << 14;
+
+// Box that is neutral with respect to merging.
+//
+constexpr auto empty_box() noexcept -> aabb3 {
+  aabb3 result{};
+  result._min = vec3{infinity};
+  result._max = vec3{-infinity};
+  return result;
+}
+
+constexpr auto merge(const aabb3& a, const aabb3& b) noexcept -> aabb3 {
+  return aabb3{a, b};
+}
+
+constexpr auto surface_area(const aabb3& box) noexcept -> float32 {
+  const auto d = box._max - box._min;
+  return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+struct bin {
+  aabb3 box = empty_box();
+  size_t count = 0;
+};
+
+using bins = array<array<bin, bin_count>, 3>;
+
+// Map centroids to bins along every axis
+// of the bounding box of all centroids.
+//
+struct binning {
+  explicit binning(const aabb3& box) noexcept : origin{box._min} {
+    const auto extent = box._max - box._min;
+    for (int axis = 0; axis < 3; ++axis)
+      scale[axis] = (extent[axis] > 0) ? bin_count / extent[axis] : 0.0f;
+  }
+
+  auto operator()(const vec3& centroid, int axis) const noexcept -> size_t {
+    const auto x = (centroid[axis] - origin[axis]) * scale[axis];
+    return std::min(size_t(x), bin_count - 1);
+  }
+
+  vec3 origin;
+  vec3 scale;
+};
+
+struct bvh_builder {
+  // Bounding box of all primitives
+  // and of all centroids inside a range.
+  //
+  struct bounds {
+    aabb3 box = empty_box();
+    aabb3 centroids = empty_box();
+  };
+
+  // Upper levels have only few nodes. There, the passes over
+  // the primitives of a single node are distributed over all threads.
+  // The number of threads decreases with every level.
+  //
+  auto chunks(size_t size, size_t depth) const noexcept -> size_t {
+    if (size < parallel_threshold) return 1;
+    return std::max<size_t>(chunk_count(size, parallel_threshold) >> depth,
+                            1);
+  }
+
+  // Compute partial results for consecutive chunks
+  // of `[first, last)` in parallel and merge them in order.
+  //
+  template <typename type>
+  auto reduce(uint32 first,
+              uint32 last,
+              size_t depth,
+              auto&& accumulate,
+              auto&& merge) const -> type {
+    const auto size = size_t(last - first);
+    const auto count = chunks(size, depth);
+    type result{};
+    if (count == 1) {
+      accumulate(result, first, last);
+      return result;
+    }
+    vector<type> results(count);
+    parallel_chunks(size, count, [&](size_t chunk, size_t i, size_t j) {
+      accumulate(results[chunk], first + i, first + j);
+    });
+    for (const auto& x : results) merge(result, x);
+    return result;
+  }
+
+  auto bounds_of(uint32 first, uint32 last, size_t depth) const -> bounds {
+    return reduce<bounds>(
+        first, last, depth,
+        [&](bounds& result, uint32 i, uint32 j) {
+          for (auto k = i; k < j; ++k) {
+            const auto p = tree.primitives[k];
+            result.box = merge(result.box, boxes[p]);
+            result.centroids = aabb3{result.centroids, centroids[p]};
+          }
+        },
+        [](bounds& result, const bounds& x) {
+          result.box = merge(result.box, x.box);
+          result.centroids = merge(result.centroids, x.centroids);
+        });
+  }
+
+  auto bins_of(uint32 first,
+               uint32 last,
+               const aabb3& centroid_box,
+               size_t depth) const -> bins {
+    const binning binning{centroid_box};
+    return reduce<bins>(
+        first, last, depth,
+        [&](bins& result, uint32 i, uint32 j) {
+          for (auto k = i; k < j; ++k) {
+            const auto p = tree.primitives[k];
+            for (int axis = 0; axis < 3; ++axis) {
+              auto& b = result[axis][binning(centroids[p], axis)];
+              b.box = merge(b.box, boxes[p]);
+              ++b.count;
+            }
+          }
+        },
+        [](bins& result, const bins& x) {
+          for (int axis = 0; axis < 3; ++axis) {
+            for (size_t i = 0; i < bin_count; ++i) {
+              result[axis][i].box = merge(result[axis][i].box, x[axis][i].box);
+              result[axis][i].count += x[axis][i].count;
+            }
+          }
+        });
+  }
+
+  void build(uint32 index, uint32 first, uint32 last, size_t depth) {
+    auto& node = tree.nodes[index];
+    const auto size = size_t(last - first);
+    const auto node_bounds = bounds_of(first, last, depth);
+    const auto& box = node_bounds.box;
+    const auto& centroid_box = node_bounds.centroids;
+    node.box = box;
+
+    const auto make_leaf = [&] {
+      node.offset = first;
+      node.count = size;
+    };
+    if (size <= 1) return make_leaf();
+
+    // Find the cheapest split between bins over all axes. Traversing
+    // a node costs about as much as testing a single primitive.
+    //
+    int split_axis = -1;
+    size_t split_bin = 0;
+    auto split_cost = infinity;
+    if (depth < bvh::max_depth - 32) {
+      const auto binned = bins_of(first, last, centroid_box, depth);
+      for (int axis = 0; axis < 3; ++axis) {
+        if (centroid_box._max[axis] <= centroid_box._min[axis]) continue;
+        const auto& b = binned[axis];
+        array<float32, bin_count> right_costs{};
+        bin right{};
+        for (size_t i = bin_count - 1; i > 0; --i) {
+          right.box = merge(right.box, b[i].box);
+          right.count += b[i].count;
+          right_costs[i] = right.count ? right.count * surface_area(right.box)
+                                       : 0.0f;
+        }
+        bin left{};
+        for (size_t i = 1; i < bin_count; ++i) {
+          left.box = merge(left.box, b[i - 1].box);
+          left.count += b[i - 1].count;
+          if ((left.count == 0) || (left.count == size)) continue;
+          const auto cost =
+              left.count * surface_area(left.box) + right_costs[i];
+          if (cost < split_cost) {
+            split_cost = cost;
+            split_axis = axis;
+            split_bin = i;
+          }
+        }
+      }
+      const auto leaf_cost = size * surface_area(box);
+      if ((size <= max_leaf_size) &&
+          ((split_axis < 0) || (surface_area(box) + split_cost >= leaf_cost)))
+        return make_leaf();
+    } else if (size <= max_leaf_size)
+      return make_leaf();
+
+    // Partition the primitives. If no split by bins is possible,
+    // because all centroids coincide or the depth limit has been reached,
+    // the primitives are split in half. The depth limit makes sure that at
+    // most 32 such splits follow. So, the tree never exceeds its maximal depth.
+    //
+    auto middle = first + uint32(size / 2);
+    if (split_axis >= 0) {
+      const binning binning{centroid_box};
+      const auto it = std::partition(
+          tree.primitives.begin() + first, tree.primitives.begin() + last,
+          [&](uint32 p) {
+            return binning(centroids[p], split_axis) < split_bin;
+          });
+      middle = uint32(it - tree.primitives.begin());
+    }
+
+    const auto child = node_count.fetch_add(2);
+    node.offset = child;
+    node.count = 0;
+
+    // Build independent subtrees concurrently.
+    //
+    if ((middle - first >= parallel_threshold) &&
+        (last - middle >= parallel_threshold)) {
+      auto task = std::async(std::launch::async, [&, child, first, middle] {
+        build(child, first, middle, depth + 1);
+      });
+      build(child + 1, middle, last, depth + 1);
+      task.get();
+    } else {
+      build(child, first, middle, depth + 1);
+      build(child + 1, middle, last, depth + 1);
+    }
+  }
+
+  std::span<const aabb3> boxes;
+  vector<vec3> centroids{};
+  bvh& tree;
+  std::atomic<uint32> node_count{1};
+};
+
+auto refit_subtree(bvh& tree, std::span<const aabb3> boxes, uint32 index)
+    -> aabb3 {
+  auto& node = tree.nodes[index];
+  if (node.is_leaf()) {
+    auto box = boxes[tree.primitives[node.offset]];
+    for (auto i = node.offset + 1; i < node.offset + node.count; ++i)
+      box = merge(box, boxes[tree.primitives[i]]);
+    node.box = box;
+  } else {
+    node.box = merge(refit_subtree(tree, boxes, node.offset),
+                     refit_subtree(tree, boxes, node.offset + 1));
+  }
+  return node.box;
+}
+
+}  // namespace
+
+auto bvh_from(std::span<const aabb3> boxes) -> bvh {
+  bvh result{};
+  if (boxes.empty()) return result;
+
+  // Every leaf contains at least one primitive.
+  // So, there are at most `2n - 1` nodes.
+  //
+  result.nodes.resize(2 * boxes.size() - 1);
+  result.primitives.resize(boxes.size());
+  bvh_builder builder{boxes, vector<vec3>(boxes.size()), result};
+  parallel_for(boxes.size(), [&](size_t i) {
+    result.primitives[i] = i;
+    builder.centroids[i] = boxes[i].origin();
+  });
+  builder.build(0, 0, boxes.size(), 0);
+  result.nodes.resize(builder.node_count);
+  result.nodes.shrink_to_fit();
+  return result;
+}
+
+auto bvh_from(const polyhedral_surface& surface) -> bvh {
+  vector<aabb3> boxes(surface.faces.size());
+  parallel_for(surface.faces.size(), [&](size_t i) {
+    const auto& f = surface.faces[i];
+    const auto& v = surface.vertices;
+    boxes[i] = aabb3{aabb3{v[f[0]].position, v[f[1]].position},
+                     v[f[2]].position};
+  });
+  return bvh_from(boxes);
+}
+
+void refit(bvh& tree, std::span<const aabb3> boxes) {
+  if (tree.empty()) return;
+
+  // Split the tree into its upper levels and enough independent subtrees
+  // below them to keep all threads busy. The subtrees are refitted in
+  // parallel. Afterwards, the few nodes of the upper levels are updated
+  // in reverse breadth-first order such that children come first.
+  //
+  const auto target = 8 * thread_count();
+  vector<uint32> upper{};
+  vector<uint32> subtrees{0};
+  while (subtrees.size() < target) {
+    vector<uint32> next{};
+    next.reserve(2 * subtrees.size());
+    for (auto index : subtrees) {
+      const auto& node = tree.nodes[index];
+      if (node.is_leaf()) {
+        next.push_back(index);
+        continue;
+      }
+      upper.push_back(index);
+      next.push_back(node.offset);
+      next.push_back(node.offset + 1);
+    }
+    if (next.size() == subtrees.size()) break;
+    subtrees = std::move(next);
+  }
+
+  parallel_for_dynamic(subtrees.size(), [&](size_t i) {
+    refit_subtree(tree, boxes, subtrees[i]);
+  });
+  for (auto it = upper.rbegin(); it != upper.rend(); ++it) {
+    auto& node = tree.nodes[*it];
+    node.box = merge(tree.nodes[node.offset].box,
+                     tree.nodes[node.offset + 1].box);
+  }
+}
+
+}  // namespace ensketch::sandbox
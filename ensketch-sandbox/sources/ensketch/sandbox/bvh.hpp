@@ -0,0 +1,61 @@
+#pragma once
+#include <ensketch/sandbox/aabb.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+
+namespace ensketch::sandbox {
+
+/// Bounding volume hierarchy over the axis-aligned bounding boxes of
+/// primitives, like the faces of a polyhedral surface. It is built top-down
+/// by evaluating the surface area heuristic (SAH) on a fixed number of bins.
+/// All nodes are stored in a single array in which the two children of an
+/// inner node are adjacent. Every leaf references a consecutive range of
+/// `primitives` which is a permutation of the primitive indices.
+///
+struct bvh {
+  /// The builder never creates deeper trees.
+  /// Hence, traversals may use fixed-size stacks.
+  ///
+  static constexpr size_t max_depth = 64;
+
+  struct node {
+    bool is_leaf() const noexcept { return count > 0; }
+
+    aabb3 box{};
+    // Index of the first child for inner nodes and
+    // index of the first primitive in `primitives` for leaves.
+    uint32 offset{};
+    // Number of primitives for leaves and zero for inner nodes.
+    uint32 count{};
+  };
+
+  bool empty() const noexcept { return nodes.empty(); }
+  auto root() const noexcept -> const node& { return nodes.front(); }
+
+  vector<node> nodes{};
+  vector<uint32> primitives{};
+};
+
+/// Constructor Extension for BVH
+/// Build the BVH over the given bounding boxes of primitives in parallel.
+/// The upper levels distribute the binning of every node over all threads
+/// whereas the lower levels build independent subtrees concurrently.
+/// Primitive `i` is referenced by the index `i` in `bvh::primitives`.
+///
+auto bvh_from(std::span<const aabb3> boxes) -> bvh;
+
+/// Constructor Extension for BVH
+/// Build the BVH over all faces of a polyhedral surface.
+/// It needs to be rebuilt whenever the surface changes.
+///
+auto bvh_from(const polyhedral_surface& surface) -> bvh;
+
+/// Update the bounding boxes of all nodes for new bounding boxes of the
+/// primitives without changing the structure of the tree. This takes linear
+/// time and is much faster than a rebuild. It is meant for primitives that
+/// move continuously, like the faces of an animated mesh. The quality of the
+/// tree degrades if primitives move far from their original neighbors.
+/// Independent subtrees are refitted in parallel.
+///
+void refit(bvh& tree, std::span<const aabb3> boxes);
+
+}  // namespace ensketch::sandbox
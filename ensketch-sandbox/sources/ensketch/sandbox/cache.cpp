@@ -0,0 +1,116 @@
+#include <ensketch/sandbox/cache.hpp>
+//
+#include <ensketch/sandbox/memory_mapped_file.hpp>
+#include <ensketch/sandbox/parallel.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+// Finalizer of SplitMix64 to spread all bits over the whole hash.
+//
+constexpr auto mix(uint64 x) noexcept -> uint64 {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+// Hash a block of bytes by consuming whole 64-bit words.
+// This is much faster than byte-wise hashing for large files.
+//
+auto block_hash(const char* data, size_t size) noexcept -> uint64 {
+  constexpr uint64 k0 = 0x9e3779b97f4a7c15ull;
+  constexpr uint64 k1 = 0xc2b2ae3d27d4eb4full;
+  uint64 hash = mix(size);
+  size_t i = 0;
+  for (; i + sizeof(uint64) <= size; i += sizeof(uint64)) {
+    uint64 word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = std::rotl(hash ^ (word * k0), 31) * k1;
+  }
+  uint64 tail = 0;
+  std::memcpy(&tail, data + i, size - i);
+  return mix(hash ^ (tail * k0));
+}
+
+}  // namespace
+
+auto cache_directory() -> std::filesystem::path {
+  const auto from_env = [](czstring name) -> std::filesystem::path {
+    const auto value = std::getenv(name);
+    if (!value || !*value) return {};
+    return value;
+  };
+
+  auto path = from_env("ENSKETCH_SANDBOX_CACHE_DIR");
+  if (path.empty()) {
+#if defined(_WIN32)
+    auto base = from_env("LOCALAPPDATA");
+#else
+    auto base = from_env("XDG_CACHE_HOME");
+    if (base.empty()) {
+      base = from_env("HOME");
+      if (!base.empty()) base /= ".cache";
+    }
+#endif
+    if (base.empty()) base = std::filesystem::temp_directory_path();
+    path = base / "ensketch-sandbox";
+  }
+
+  std::error_code error{};
+  std::filesystem::create_directories(path, error);
+  if (error)
+    throw std::runtime_error(
+        std::format("Failed to create cache directory '{}'. {}",
+                    path.string(), error.message()));
+  return path;
+}
+
+auto content_hash_of(const std::filesystem::path& path) -> uint64 {
+  const memory_mapped_file file{path};
+  constexpr size_t block_size = size_t{1} << 20;
+  const auto block_count = (file.size() + block_size - 1) / block_size;
+  std::vector<uint64> hashes(block_count);
+  parallel_for(
+      block_count,
+      [&](size_t i) {
+        const auto first = i * block_size;
+        const auto size = std::min(block_size, file.size() - first);
+        hashes[i] = block_hash(file.data() + first, size);
+      },
+      1);
+  auto hash = mix(file.size());
+  for (const auto h : hashes) hash = mix(hash ^ h);
+  return hash;
+}
+
+void write_file_atomically(const std::filesystem::path& path,
+                           const std::function<void(std::ostream&)>& write) {
+  // Different threads and processes must not share temporary files.
+  //
+  const auto id = std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+                  clock::now().time_since_epoch().count();
+  auto tmp = path;
+  tmp += std::format(".{:016x}.tmp", id);
+
+  try {
+    {
+      std::ofstream file{tmp, std::ios::binary | std::ios::trunc};
+      if (!file) throw std::runtime_error("The file could not be opened.");
+      write(file);
+      file.flush();
+      if (!file) throw std::runtime_error("The file could not be written.");
+    }
+    std::filesystem::rename(tmp, path);
+  } catch (std::exception& e) {
+    std::error_code error{};
+    std::filesystem::remove(tmp, error);
+    throw std::runtime_error(std::format("Failed to write file '{}'. {}",
+                                         path.string(), e.what()));
+  }
+}
+
+}  // namespace ensketch::sandbox
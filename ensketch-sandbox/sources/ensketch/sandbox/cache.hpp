@@ -0,0 +1,42 @@
+#pragma once
+#include <ensketch/sandbox/defaults.hpp>
+
+namespace ensketch::sandbox {
+
+/// Return the directory in which derived data, like preprocessed meshes,
+/// is cached across runs. The directory is created if it does not exist.
+/// The environment variable `ENSKETCH_SANDBOX_CACHE_DIR` takes precedence.
+/// Otherwise, the platform's user cache directory is used.
+///
+auto cache_directory() -> std::filesystem::path;
+
+/// 64-bit FNV-1a hash of the given bytes.
+/// The hash is stable across runs and platforms and only meant to
+/// derive names for cache files, not for any cryptographic purposes.
+///
+constexpr auto fnv1a_hash(std::string_view bytes,
+                          uint64 hash = 0xcbf29ce484222325ull) noexcept
+    -> uint64 {
+  for (const auto c : bytes) {
+    hash ^= static_cast<uint8>(c);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+/// Hash the whole content of the given file.
+/// The file is memory-mapped and hashed in parallel by chunks whose
+/// hashes are afterwards combined in order. So, the result does not
+/// depend on the number of threads. Throws `std::runtime_error`
+/// if the file cannot be read.
+///
+auto content_hash_of(const std::filesystem::path& path) -> uint64;
+
+/// Write a file by calling `write(stream)` on a temporary file next to `path`
+/// and renaming it afterwards. Concurrent readers therefore never observe
+/// partially written files. Throws `std::runtime_error` on failure.
+///
+void write_file_atomically(const std::filesystem::path& path,
+                           const std::function<void(std::ostream&)>& write);
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,158 @@
+#include <ensketch/sandbox/closest_point.hpp>
+//
+#include <ensketch/sandbox/parallel.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+// Parameter of the point on the segment from `a` to `b` closest to `p`.
+//
+auto closest_parameter(const vec3& a, const vec3& b, const vec3& p) noexcept
+    -> float32 {
+  const auto ab = b - a;
+  const auto l = dot(ab, ab);
+  return (l > 0.0f) ? std::clamp(dot(p - a, ab) / l, 0.0f, 1.0f) : 0.0f;
+}
+
+// Closest point on a triangle whose vertices are collinear
+// by checking all three edges.
+//
+auto degenerate_closest_point(const triangle& f, const vec3& p) noexcept
+    -> triangle_point {
+  const auto t0 = closest_parameter(f[0], f[1], p);
+  const auto t1 = closest_parameter(f[0], f[2], p);
+  const auto t2 = closest_parameter(f[1], f[2], p);
+  const array<triangle_point, 3> points{
+      triangle_point{t0, 0.0f}, triangle_point{0.0f, t1},
+      triangle_point{1.0f - t2, t2}};
+  triangle_point result{};
+  auto best = infinity;
+  for (const auto& x : points) {
+    const auto q = (1.0f - x.u - x.v) * f[0] + x.u * f[1] + x.v * f[2];
+    const auto d = dot(q - p, q - p);
+    if (d < best) {
+      best = d;
+      result = x;
+    }
+  }
+  return result;
+}
+
+// Squared distance from a point to a box
+// which is zero for points inside the box.
+//
+auto distance2(const aabb3& box, const vec3& p) noexcept -> float32 {
+  const auto d = glm::max(glm::max(box._min - p, p - box._max), vec3{0.0f});
+  return dot(d, d);
+}
+
+}  // namespace
+
+// The Voronoi regions of vertices and edges are checked one after another
+// as described by Christer Ericson in "Real-Time Collision Detection".
+//
+auto closest_point(const triangle& f, const vec3& p) noexcept
+    -> triangle_point {
+  const auto ab = f[1] - f[0];
+  const auto ac = f[2] - f[0];
+  const auto ap = p - f[0];
+  const auto d1 = dot(ab, ap);
+  const auto d2 = dot(ac, ap);
+  if ((d1 <= 0.0f) && (d2 <= 0.0f)) return {0.0f, 0.0f};
+
+  const auto bp = p - f[1];
+  const auto d3 = dot(ab, bp);
+  const auto d4 = dot(ac, bp);
+  if ((d3 >= 0.0f) && (d4 <= d3)) return {1.0f, 0.0f};
+
+  const auto vc = d1 * d4 - d3 * d2;
+  if ((vc <= 0.0f) && (d1 >= 0.0f) && (d3 <= 0.0f) && (d1 > d3))
+    return {d1 / (d1 - d3), 0.0f};
+
+  const auto cp = p - f[2];
+  const auto d5 = dot(ab, cp);
+  const auto d6 = dot(ac, cp);
+  if ((d6 >= 0.0f) && (d5 <= d6)) return {0.0f, 1.0f};
+
+  const auto vb = d5 * d2 - d1 * d6;
+  if ((vb <= 0.0f) && (d2 >= 0.0f) && (d6 <= 0.0f) && (d2 > d6))
+    return {0.0f, d2 / (d2 - d6)};
+
+  const auto va = d3 * d6 - d5 * d4;
+  if ((va <= 0.0f) && ((d4 - d3) >= 0.0f) && ((d5 - d6) >= 0.0f) &&
+      ((d4 - d3) + (d5 - d6) > 0.0f)) {
+    const auto w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    return {1.0f - w, w};
+  }
+
+  const auto sum = va + vb + vc;
+  if (!(sum > 0.0f)) return degenerate_closest_point(f, p);
+  return {vb / sum, vc / sum};
+}
+
+auto closest_point(const polyhedral_surface& surface,
+                   const bvh& tree,
+                   const vec3& p,
+                   float32 max_distance) noexcept -> surface_point {
+  surface_point result{};
+  if (tree.empty()) return result;
+  auto bound = max_distance * max_distance;
+
+  const auto& v = surface.vertices;
+  const auto test = [&](uint32 fid) {
+    const auto& f = surface.faces[fid];
+    const triangle t{v[f[0]].position, v[f[1]].position, v[f[2]].position};
+    const auto x = closest_point(t, p);
+    const auto q = (1.0f - x.u - x.v) * t[0] + x.u * t[1] + x.v * t[2];
+    const auto d = dot(q - p, q - p);
+    if ((d > bound) || ((d == bound) && (fid > result.f))) return;
+    bound = d;
+    static_cast<triangle_point&>(result) = x;
+    result.f = fid;
+    result.position = q;
+  };
+
+  // Children are visited front to back like for ray intersections.
+  //
+  array<pair<uint32, float32>, bvh::max_depth> stack;
+  size_t size = 0;
+  stack[size++] = {0, distance2(tree.root().box, p)};
+  while (size > 0) {
+    const auto [index, d] = stack[--size];
+    if (d > bound) continue;
+    const auto& node = tree.nodes[index];
+
+    if (node.is_leaf()) {
+      for (auto i = node.offset; i < node.offset + node.count; ++i)
+        test(tree.primitives[i]);
+      continue;
+    }
+
+    auto near = pair{node.offset, distance2(tree.nodes[node.offset].box, p)};
+    auto far =
+        pair{node.offset + 1, distance2(tree.nodes[node.offset + 1].box, p)};
+    if (far.second < near.second) swap(near, far);
+    if (far.second <= bound) stack[size++] = far;
+    if (near.second <= bound) stack[size++] = near;
+  }
+
+  if (result) result.distance = std::sqrt(bound);
+  return result;
+}
+
+auto closest_points(const polyhedral_surface& surface,
+                    const bvh& tree,
+                    std::span<const vec3> queries,
+                    float32 max_distance) -> vector<surface_point> {
+  vector<surface_point> result(queries.size());
+  parallel_for(
+      queries.size(),
+      [&](size_t i) {
+        result[i] = closest_point(surface, tree, queries[i], max_distance);
+      },
+      size_t{64});
+  return result;
+}
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,51 @@
+#pragma once
+#include <ensketch/sandbox/bvh.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+#include <ensketch/sandbox/ray_tracer.hpp>
+
+namespace ensketch::sandbox {
+
+/// Point on a triangle given by barycentric coordinates with respect to the
+/// second and third vertex, like the parameters of ray-triangle intersections.
+///
+struct triangle_point {
+  float32 u{};
+  float32 v{};
+};
+
+/// Return the point on the triangle that is closest to `p`.
+/// Degenerate triangles are handled like the segments they collapse to.
+///
+auto closest_point(const triangle& f, const vec3& p) noexcept
+    -> triangle_point;
+
+/// Closest point on a polyhedral surface to a given query point.
+///
+struct surface_point : triangle_point {
+  operator bool() const noexcept { return f != polyhedral_surface::invalid; }
+
+  polyhedral_surface::face_id f = polyhedral_surface::invalid;
+  vec3 position{};
+  float32 distance = infinity;
+};
+
+/// Return the point of the surface that is closest to `p` by traversing
+/// a BVH that has been built over the surface's faces. Only points whose
+/// distance is at most `max_distance` are considered. Equal distances are
+/// resolved in favor of the smaller face index. The result is invalid if
+/// there is no such point.
+///
+auto closest_point(const polyhedral_surface& surface,
+                   const bvh& tree,
+                   const vec3& p,
+                   float32 max_distance = infinity) noexcept -> surface_point;
+
+/// Answer the closest-point query for every given point in parallel.
+/// The results are returned in the order of the given points.
+///
+auto closest_points(const polyhedral_surface& surface,
+                    const bvh& tree,
+                    std::span<const vec3> queries,
+                    float32 max_distance = infinity) -> vector<surface_point>;
+
+}  // namespace ensketch::sandbox
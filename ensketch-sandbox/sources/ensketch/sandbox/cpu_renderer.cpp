@@ -0,0 +1,233 @@
+#include <ensketch/sandbox/cpu_renderer.hpp>
+//
+#include <ensketch/sandbox/parallel.hpp>
+#include <ensketch/sandbox/ray_tracer.hpp>
+//
+// The implementation of stb_image_write is compiled in this unit only.
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+// Port of the colormap in the viewer's fragment shader.
+//
+auto colormap_h(float x) noexcept -> float {
+  if (x < 0.1151580585723306f)
+    return (2.25507158009032f * x - 1.17973110308697f) * x +
+           7.72551618145170e-1f;
+  if (x < (9.89643667779019e-1f - 6.61604251019618e-1f) /
+              (2.80520737708568f - 1.40111938331467f))
+    return -2.80520737708568f * x + 9.89643667779019e-1f;
+  if (x < (6.61604251019618e-1f - 4.13849520734156e-1f) /
+              (1.40111938331467f - 7.00489176507247e-1f))
+    return -1.40111938331467f * x + 6.61604251019618e-1f;
+  if (x < (4.13849520734156e-1f - 2.48319927251200e-1f) /
+              (7.00489176507247e-1f - 3.49965224045823e-1f))
+    return -7.00489176507247e-1f * x + 4.13849520734156e-1f;
+  return -3.49965224045823e-1f * x + 2.48319927251200e-1f;
+}
+
+auto colormap_v(float x) noexcept -> float {
+  float v = (x < 0.5f)
+                ? std::clamp(2.10566088679245f * x + 7.56360684411500e-1f,
+                             0.0f, 1.0f)
+                : std::clamp(-1.70132918347782f * x + 2.20637371757606f,
+                             0.0f, 1.0f);
+  const float period = 4.0f / 105.0f;
+  const float len = 3.0f / 252.0f;
+  // GLSL's `mod` rounds towards negative infinity.
+  const float y = x + 7.0f / 252.0f;
+  const float t = y - period * std::floor(y / period);
+  if ((0.0f <= t) && (t < len)) {
+    if (x < 0.12f)
+      v = 1.87862631683169f * x + 6.81498517051705e-1f;
+    else if (x < 0.73f)
+      v -= 26.0f / 252.0f;
+    else
+      v = -1.53215278202992f * x + 1.98649818445446f;
+  }
+  return v;
+}
+
+auto colormap_hsv2rgb(float h, float s, float v) noexcept -> vec3 {
+  float r = v;
+  float g = v;
+  float b = v;
+  if (s > 0.0f) {
+    h *= 6.0f;
+    const int i = int(h);
+    const float f = h - float(i);
+    if (i == 1) {
+      r *= 1.0f - s * f;
+      b *= 1.0f - s;
+    } else if (i == 2) {
+      r *= 1.0f - s;
+      b *= 1.0f - s * (1.0f - f);
+    } else if (i == 3) {
+      r *= 1.0f - s;
+      g *= 1.0f - s * f;
+    } else if (i == 4) {
+      r *= 1.0f - s * (1.0f - f);
+      g *= 1.0f - s;
+    } else if (i == 5) {
+      g *= 1.0f - s;
+      b *= 1.0f - s * f;
+    } else {
+      g *= 1.0f - s * (1.0f - f);
+      b *= 1.0f - s;
+    }
+  }
+  return {r, g, b};
+}
+
+auto colormap(float x) noexcept -> vec3 {
+  x = std::clamp(x, 0.0f, 1.0f);
+  return colormap_hsv2rgb(colormap_h(x), 1.0f, colormap_v(x));
+}
+
+auto smoothstep(float edge0, float edge1, float x) noexcept -> float {
+  const auto t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+  return t * t * (3.0f - 2.0f * t);
+}
+
+// Shades hits of primary rays like the viewer's surface shader.
+//
+struct shader {
+  // Distance in pixels from the pixel to the nearest edge of the face
+  // in screen space, like the distance computed by the geometry shader.
+  //
+  auto edge_distance(const vec2& pixel, const polyhedral_surface::face& f)
+      const noexcept -> float {
+    array<vec2, 3> p;
+    for (int k = 0; k < 3; ++k) {
+      const auto q = screen_position(camera, surface.vertices[f[k]].position);
+      if (!q) return infinity;
+      p[k] = *q;
+    }
+    auto result = infinity;
+    for (int k = 0; k < 3; ++k) {
+      const auto a = p[k];
+      const auto e = p[(k + 1) % 3] - a;
+      const auto l = length(e);
+      if (l == 0.0f) continue;
+      const auto r = pixel - a;
+      result = std::min(result, std::abs(e.x * r.y - e.y * r.x) / l);
+    }
+    return result;
+  }
+
+  auto operator()(const vec2& pixel,
+                  const ray_polyhedral_surface_intersection& hit)
+      const noexcept -> vec3 {
+    const auto& f = surface.faces[hit.f];
+    const auto& v = surface.vertices;
+    const auto w = 1.0f - hit.u - hit.v;
+
+    const auto n = options.use_face_normal
+                       ? cross(v[f[1]].position - v[f[0]].position,
+                               v[f[2]].position - v[f[0]].position)
+                       : w * v[f[0]].normal + hit.u * v[f[1]].normal +
+                             hit.v * v[f[2]].normal;
+    const auto l = length(n);
+    const auto s =
+        (l > 0.0f) ? std::abs(dot(n, camera.direction())) / l : 0.0f;
+    const auto light = 0.2f + std::pow(s, 1000.0f) + 0.75f * std::pow(s, 0.2f);
+
+    auto color = vec3{light};
+    if (!field.empty()) {
+      const auto phi =
+          w * field[f[0]] + hit.u * field[f[1]] + hit.v * field[f[2]];
+      color *= colormap((phi - field_min) * field_scale);
+    }
+
+    if (options.wireframe) {
+      const float line_width = 0.01f;
+      const float line_delta = 1.0f;
+      const auto t = smoothstep(line_width - line_delta,
+                                line_width + line_delta,
+                                edge_distance(pixel, f));
+      color = mix(vec3{0.5f}, color, t);
+    }
+    return color;
+  }
+
+  const opengl::camera& camera;
+  const polyhedral_surface& surface;
+  std::span<const float32> field;
+  const cpu_render_options& options;
+  float field_min = 0.0f;
+  float field_scale = 0.0f;
+};
+
+}  // namespace
+
+void store_png(const rgb_image& image, const filesystem::path& path) {
+  stbi_flip_vertically_on_write(false);
+  if (!stbi_write_png(path.c_str(), image.width, image.height, 3,
+                      image.pixels.data(), 3 * image.width))
+    throw runtime_error(
+        format("Failed to write PNG image to path '{}'.", path.string()));
+}
+
+auto render(const opengl::camera& camera,
+            const polyhedral_surface& surface,
+            const bvh& tree,
+            const cpu_render_options& options) -> rgb_image {
+  return render(camera, surface, tree, {}, options);
+}
+
+auto render(const opengl::camera& camera,
+            const polyhedral_surface& surface,
+            const bvh& tree,
+            std::span<const float32> field,
+            const cpu_render_options& options) -> rgb_image {
+  if (!field.empty() && (field.size() != surface.vertices.size()))
+    throw runtime_error(
+        format("Failed to render surface. The scalar field provides {} values "
+               "for {} vertices.",
+               field.size(), surface.vertices.size()));
+
+  rgb_image image{};
+  image.width = camera.screen_width();
+  image.height = camera.screen_height();
+  image.pixels.resize(3 * size_t(image.width) * image.height);
+
+  shader shade{camera, surface, field, options};
+  if (!field.empty()) {
+    const auto [min, max] = std::ranges::minmax(field);
+    shade.field_min = min;
+    shade.field_scale = (max > min) ? 1.0f / (max - min) : 0.0f;
+  }
+
+  const auto to_byte = [](float x) {
+    return uint8(std::clamp(x, 0.0f, 1.0f) * 255.0f + 0.5f);
+  };
+
+  const auto tile_size = std::max(options.tile_size, 1);
+  const auto tiles_x = (image.width + tile_size - 1) / tile_size;
+  const auto tiles_y = (image.height + tile_size - 1) / tile_size;
+  // Tiles are handed out dynamically, because the cost
+  // of a tile depends on how much of the surface it covers.
+  parallel_for_dynamic(size_t(tiles_x) * tiles_y, [&](size_t tile) {
+    const auto x0 = int(tile % tiles_x) * tile_size;
+    const auto y0 = int(tile / tiles_x) * tile_size;
+    const auto x1 = std::min(x0 + tile_size, image.width);
+    const auto y1 = std::min(y0 + tile_size, image.height);
+    for (auto y = y0; y < y1; ++y) {
+      for (auto x = x0; x < x1; ++x) {
+        const vec2 pixel{x + 0.5f, y + 0.5f};
+        const auto r = primary_ray(camera, pixel.x, pixel.y);
+        const auto hit = tree.empty() ? ray_polyhedral_surface_intersection{}
+                                      : intersection(r, surface, tree);
+        const auto color = hit ? shade(pixel, hit) : options.background;
+        auto p = image(x, y);
+        for (int k = 0; k < 3; ++k) p[k] = to_byte(color[k]);
+      }
+    }
+  });
+  return image;
+}
+
+}  // namespace ensketch::sandbox
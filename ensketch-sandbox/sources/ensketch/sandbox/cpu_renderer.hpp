@@ -0,0 +1,62 @@
+#pragma once
+#include <ensketch/sandbox/bvh.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+#include <ensketch/sandbox/utility.hpp>
+//
+#include <ensketch/opengl/camera.hpp>
+
+namespace ensketch::sandbox {
+
+/// Image with three 8-bit color channels per pixel. Rows are stored
+/// contiguously from top to bottom like the pixels of the screen.
+///
+struct rgb_image {
+  auto operator()(int x, int y) noexcept -> uint8* {
+    return &pixels[3 * (size_t(y) * width + x)];
+  }
+
+  int width{};
+  int height{};
+  vector<uint8> pixels{};
+};
+
+/// Store the image as PNG file at the given path.
+///
+void store_png(const rgb_image& image, const filesystem::path& path);
+
+/// Options of the CPU renderer that correspond
+/// to the uniforms of the viewer's surface shader.
+///
+struct cpu_render_options {
+  bool wireframe = false;
+  bool use_face_normal = false;
+  vec3 background{1.0f};
+  /// Width and height in pixels of the tiles that are
+  /// rendered as a whole by a single thread.
+  int tile_size = 16;
+};
+
+/// Render the surface as seen by the camera without an OpenGL context.
+/// For every pixel, a primary ray through its center is intersected with
+/// the surface by traversing the given BVH. The shading is the same as in
+/// the viewer's fragment shader. The screen is split into square tiles that
+/// threads render one after another. So, neighboring rays of a thread are
+/// coherent and the work is balanced for surfaces that cover only parts of
+/// the screen.
+///
+auto render(const opengl::camera& camera,
+            const polyhedral_surface& surface,
+            const bvh& tree,
+            const cpu_render_options& options = {}) -> rgb_image;
+
+/// Render the surface and color it by a scalar field that provides one value
+/// per vertex. The values are linearly mapped from their range onto the
+/// colormap of the viewer and the lighting is applied to the resulting color.
+///
+auto render(const opengl::camera& camera,
+            const polyhedral_surface& surface,
+            const bvh& tree,
+            std::span<const float32> field,
+            const cpu_render_options& options = {}) -> rgb_image;
+
+}  // namespace ensketch::sandbox
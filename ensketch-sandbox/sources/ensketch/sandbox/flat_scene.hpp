@@ -1,6 +1,7 @@
 #pragma once
 #include <ensketch/sandbox/aabb.hpp>
 #include <ensketch/sandbox/defaults.hpp>
+#include <ensketch/sandbox/scene.hpp>
 
 namespace ensketch::sandbox {
 
@@ -48,6 +49,12 @@ struct flat_scene {
 ///
 auto aabb_from(const flat_scene& scene) noexcept -> aabb3;
 
+/// Flatten the meshes and the node hierarchy of an imported scene.
+///
+auto flat_scene_from(const scene& in) -> flat_scene;
+
+/// Import the given file as scene and flatten it.
+///
 auto flat_scene_from_file(const std::filesystem::path& path) -> flat_scene;
 
 }  // namespace ensketch::sandbox
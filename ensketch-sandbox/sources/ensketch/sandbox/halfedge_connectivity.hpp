@@ -0,0 +1,143 @@
+#pragma once
+#include <ensketch/sandbox/parallel.hpp>
+#include <ensketch/sandbox/utility.hpp>
+
+namespace ensketch::sandbox {
+
+/// Compact and array-based connectivity of a triangle surface.
+/// Halfedges are not stored explicitly. Instead, halfedge `3 * f + k`
+/// runs from corner `k` to corner `(k + 1) % 3` of face `f`.
+/// So, `face`, `next` and `prev` are simple arithmetic.
+/// Twins are stored as a plain array. The outgoing halfedges of all
+/// vertices are stored in compressed sparse row (CSR) format sorted by
+/// their target vertex. So, looking up the halfedge for a pair of vertices
+/// amounts to a binary search inside a single vertex's row.
+///
+struct halfedge_connectivity {
+  using size_type = uint32;
+  using vertex_id = uint32;
+  using face_id = uint32;
+  using halfedge_id = uint32;
+
+  static constexpr uint32 invalid = -1;
+
+  static constexpr auto face(halfedge_id h) noexcept -> face_id {
+    return h / 3;
+  }
+  static constexpr auto next(halfedge_id h) noexcept -> halfedge_id {
+    return (h % 3 == 2) ? h - 2 : h + 1;
+  }
+  static constexpr auto prev(halfedge_id h) noexcept -> halfedge_id {
+    return (h % 3 == 0) ? h + 2 : h - 1;
+  }
+
+  auto vertex_count() const noexcept -> size_t { return offsets.size() - 1; }
+  auto halfedge_count() const noexcept -> size_t { return twins.size(); }
+
+  // Return the oppositely oriented halfedge of `h`.
+  // For boundary halfedges, `invalid` is returned.
+  //
+  auto twin(halfedge_id h) const noexcept -> halfedge_id { return twins[h]; }
+
+  // Return the face on the other side of `h` or `invalid` for boundaries.
+  //
+  auto opposite_face(halfedge_id h) const noexcept -> face_id {
+    const auto t = twins[h];
+    return (t == invalid) ? invalid : face(t);
+  }
+
+  // Outgoing halfedges of vertex `v` and their target vertices.
+  // Both ranges are sorted by the target vertex.
+  //
+  auto outgoing(vertex_id v) const noexcept -> std::span<const halfedge_id> {
+    return {halfedges.data() + offsets[v], halfedges.data() + offsets[v + 1]};
+  }
+  auto targets_of(vertex_id v) const noexcept -> std::span<const vertex_id> {
+    return {targets.data() + offsets[v], targets.data() + offsets[v + 1]};
+  }
+
+  // Return the halfedge from `p` to `q` or `invalid` if it does not exist.
+  // For non-manifold input with multiple such halfedges,
+  // the one with the smallest ID is returned.
+  //
+  auto halfedge(vertex_id p, vertex_id q) const noexcept -> halfedge_id {
+    if (p >= vertex_count()) return invalid;
+    const auto row = targets_of(p);
+    const auto it = std::ranges::lower_bound(row, q);
+    if ((it == row.end()) || (*it != q)) return invalid;
+    return halfedges[offsets[p] + (it - row.begin())];
+  }
+
+  bool contains(vertex_id p, vertex_id q) const noexcept {
+    return halfedge(p, q) != invalid;
+  }
+
+  vector<size_type> offsets{0};
+  vector<vertex_id> targets{};
+  vector<halfedge_id> halfedges{};
+  vector<halfedge_id> twins{};
+};
+
+/// Build the connectivity of the given triangles over `vertex_count` vertices.
+/// All directed edges are radix-sorted in parallel by their source and target.
+/// The CSR rows and twins are afterwards found independently for each
+/// vertex and halfedge. So, construction is deterministic.
+/// Faces may be given by any random-access range of vertex triples.
+///
+auto halfedge_connectivity_from(const auto& faces, size_t vertex_count)
+    -> halfedge_connectivity {
+  constexpr auto invalid = halfedge_connectivity::invalid;
+
+  const auto halfedge_count = 3 * faces.size();
+  if ((vertex_count >= invalid) || (halfedge_count >= invalid))
+    throw std::runtime_error(std::format(
+        "Failed to generate halfedge connectivity. The surface with {} "
+        "vertices and {} faces is too large.",
+        vertex_count, faces.size()));
+
+  // Encode directed edges as keys that only use as many bits as needed.
+  // Fewer bits mean fewer radix sort passes.
+  //
+  const auto bits = std::max<size_t>(std::bit_width(vertex_count), 1);
+  const auto key_from = [bits](uint64 p, uint64 q) { return (p << bits) | q; };
+
+  vector<uint64> keys(halfedge_count);
+  halfedge_connectivity result{};
+  result.halfedges.resize(halfedge_count);
+  parallel_for(halfedge_count, [&](size_t h) {
+    const auto& f = faces[h / 3];
+    const auto k = h % 3;
+    keys[h] = key_from(f[k], f[(k + 1) % 3]);
+    result.halfedges[h] = h;
+  });
+  parallel_radix_sort(keys, result.halfedges, 2 * bits);
+
+  // The rows of the CSR structure are given by binary searches
+  // for the first halfedge of every vertex.
+  //
+  result.offsets.resize(vertex_count + 1);
+  parallel_for(vertex_count + 1, [&](size_t v) {
+    result.offsets[v] = std::ranges::lower_bound(keys, key_from(v, 0)) -
+                        keys.begin();
+  });
+
+  const auto mask = (uint64{1} << bits) - 1;
+  result.targets.resize(halfedge_count);
+  parallel_for(halfedge_count,
+               [&](size_t i) { result.targets[i] = keys[i] & mask; });
+  keys = {};
+
+  // Every halfedge finds its twin by looking up the reversed edge.
+  //
+  result.twins.resize(halfedge_count);
+  parallel_for(halfedge_count, [&](size_t i) {
+    const auto h = result.halfedges[i];
+    const auto p = faces[h / 3][h % 3];
+    const auto q = result.targets[i];
+    result.twins[h] = result.halfedge(q, p);
+  });
+
+  return result;
+}
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,246 @@
+#include <ensketch/sandbox/kd_tree.hpp>
+//
+#include <ensketch/sandbox/parallel.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+// Nodes with fewer points are processed by a single thread.
+constexpr size_t parallel_threshold = size_t{1} << 14;
+
+struct kd_tree_builder {
+  void build(uint32 index, uint32 first, uint32 last) {
+    auto& node = tree.nodes[index];
+    const auto size = last - first;
+    aabb3 box{points[tree.indices[first]]};
+    for (auto i = first + 1; i < last; ++i)
+      box = aabb3{box, points[tree.indices[i]]};
+    node.box = box;
+
+    if (size <= kd_tree::max_leaf_size) {
+      node.offset = first;
+      node.count = size;
+      return;
+    }
+
+    const auto extent = box._max - box._min;
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+    const auto middle = first + size / 2;
+    std::nth_element(
+        tree.indices.begin() + first, tree.indices.begin() + middle,
+        tree.indices.begin() + last,
+        [&](uint32 i, uint32 j) { return points[i][axis] < points[j][axis]; });
+
+    const auto child = node_count.fetch_add(2);
+    node.offset = child;
+    node.count = 0;
+
+    // Build independent subtrees concurrently.
+    //
+    if (size >= 2 * parallel_threshold) {
+      auto task = std::async(std::launch::async, [&, child, first, middle] {
+        build(child, first, middle);
+      });
+      build(child + 1, middle, last);
+      task.get();
+    } else {
+      build(child, first, middle);
+      build(child + 1, middle, last);
+    }
+  }
+
+  std::span<const vec3> points;
+  kd_tree& tree;
+  std::atomic<uint32> node_count{1};
+};
+
+// Squared distance from a point to a box
+// which is zero for points inside the box.
+//
+auto distance2(const aabb3& box, const vec3& p) noexcept -> float32 {
+  const auto d = glm::max(glm::max(box._min - p, p - box._max), vec3{0.0f});
+  return dot(d, d);
+}
+
+// Visit all points of the tree that may be closer to `p` than the
+// squared distance `bound()` by calling `visit(i, d)` with the index `i` of
+// a point in tree order and its squared distance `d`. Children are visited
+// front to back and skipped as soon as the bound has shrunk below them.
+//
+void traverse(const kd_tree& tree,
+              const vec3& p,
+              auto&& bound,
+              auto&& visit) noexcept {
+  if (tree.empty()) return;
+  array<pair<uint32, float32>, kd_tree::max_depth> stack;
+  size_t size = 0;
+  stack[size++] = {0, distance2(tree.root().box, p)};
+  while (size > 0) {
+    const auto [index, d] = stack[--size];
+    if (d > bound()) continue;
+    const auto& node = tree.nodes[index];
+
+    if (node.is_leaf()) {
+      for (auto i = node.offset; i < node.offset + node.count; ++i) {
+        const auto x = tree.points[i] - p;
+        visit(i, dot(x, x));
+      }
+      continue;
+    }
+
+    auto near = pair{node.offset, distance2(tree.nodes[node.offset].box, p)};
+    auto far =
+        pair{node.offset + 1, distance2(tree.nodes[node.offset + 1].box, p)};
+    if (far.second < near.second) swap(near, far);
+    if (far.second <= bound()) stack[size++] = far;
+    if (near.second <= bound()) stack[size++] = near;
+  }
+}
+
+// Candidates are ordered by squared distance and original index.
+// So, equal distances are resolved in favor of smaller indices.
+//
+using candidate = pair<float32, uint32>;
+
+auto neighbors_from(std::span<const candidate> candidates)
+    -> vector<kd_tree::neighbor> {
+  vector<kd_tree::neighbor> result(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i)
+    result[i] = {candidates[i].second, std::sqrt(candidates[i].first)};
+  return result;
+}
+
+}  // namespace
+
+auto kd_tree_from(std::span<const vec3> points) -> kd_tree {
+  kd_tree result{};
+  if (points.empty()) return result;
+
+  // Every leaf of a tree with more than one leaf contains more
+  // than half of the maximal leaf size. This bounds the number of nodes.
+  //
+  result.nodes.resize(2 * (points.size() / (kd_tree::max_leaf_size / 2)) + 1);
+  result.indices.resize(points.size());
+  parallel_for(points.size(), [&](size_t i) { result.indices[i] = i; });
+  kd_tree_builder builder{points, result};
+  builder.build(0, 0, points.size());
+  result.nodes.resize(builder.node_count);
+  result.nodes.shrink_to_fit();
+
+  result.points.resize(points.size());
+  parallel_for(points.size(), [&](size_t i) {
+    result.points[i] = points[result.indices[i]];
+  });
+  return result;
+}
+
+auto kd_tree_from(const polyhedral_surface& surface) -> kd_tree {
+  vector<vec3> points(surface.vertices.size());
+  parallel_for(surface.vertices.size(),
+               [&](size_t i) { points[i] = surface.vertices[i].position; });
+  return kd_tree_from(points);
+}
+
+auto nearest(const kd_tree& tree, const vec3& p) noexcept
+    -> kd_tree::neighbor {
+  candidate best{infinity, kd_tree::neighbor::invalid};
+  traverse(
+      tree, p, [&] { return best.first; },
+      [&](uint32 i, float32 d) {
+        const candidate x{d, tree.indices[i]};
+        if (x < best) best = x;
+      });
+  if (best.second == kd_tree::neighbor::invalid) return {};
+  return {best.second, std::sqrt(best.first)};
+}
+
+auto nearest(const kd_tree& tree, const vec3& p, size_t k)
+    -> vector<kd_tree::neighbor> {
+  if (k == 0) return {};
+  // Max-heap of the k closest candidates found so far.
+  vector<candidate> heap{};
+  heap.reserve(std::min(k, tree.size()));
+  traverse(
+      tree, p,
+      [&] { return (heap.size() < k) ? infinity : heap.front().first; },
+      [&](uint32 i, float32 d) {
+        const candidate x{d, tree.indices[i]};
+        if (heap.size() == k) {
+          if (!(x < heap.front())) return;
+          std::ranges::pop_heap(heap);
+          heap.back() = x;
+        } else
+          heap.push_back(x);
+        std::ranges::push_heap(heap);
+      });
+  std::ranges::sort_heap(heap);
+  return neighbors_from(heap);
+}
+
+auto within(const kd_tree& tree, const vec3& p, float32 radius)
+    -> vector<kd_tree::neighbor> {
+  const auto bound = radius * radius;
+  vector<candidate> candidates{};
+  traverse(
+      tree, p, [bound] { return bound; },
+      [&](uint32 i, float32 d) {
+        if (d <= bound) candidates.push_back({d, tree.indices[i]});
+      });
+  std::ranges::sort(candidates);
+  return neighbors_from(candidates);
+}
+
+auto nearest(const kd_tree& tree, std::span<const vec3> queries)
+    -> vector<kd_tree::neighbor> {
+  vector<kd_tree::neighbor> result(queries.size());
+  parallel_for(
+      queries.size(), [&](size_t i) { result[i] = nearest(tree, queries[i]); },
+      size_t{256});
+  return result;
+}
+
+auto nearest(const kd_tree& tree, std::span<const vec3> queries, size_t k)
+    -> vector<kd_tree::neighbor> {
+  vector<kd_tree::neighbor> result(queries.size() * k);
+  parallel_for(
+      queries.size(),
+      [&](size_t i) {
+        std::ranges::copy(nearest(tree, queries[i], k), result.begin() + i * k);
+      },
+      size_t{64});
+  return result;
+}
+
+auto within(const kd_tree& tree,
+            std::span<const vec3> queries,
+            float32 radius) -> kd_tree_neighborhoods {
+  // The number of neighbors is not known in advance. So, all results
+  // are gathered first and then copied to their final location.
+  //
+  vector<vector<kd_tree::neighbor>> neighborhoods(queries.size());
+  parallel_for(
+      queries.size(),
+      [&](size_t i) { neighborhoods[i] = within(tree, queries[i], radius); },
+      size_t{64});
+
+  kd_tree_neighborhoods result{};
+  result.offsets.resize(queries.size() + 1);
+  for (size_t i = 0; i < queries.size(); ++i)
+    result.offsets[i] = neighborhoods[i].size();
+  result.offsets.back() = parallel_exclusive_scan(
+      std::span{result.offsets.data(), queries.size()});
+  result.neighbors.resize(result.offsets.back());
+  parallel_for(
+      queries.size(),
+      [&](size_t i) {
+        std::ranges::copy(neighborhoods[i],
+                          result.neighbors.begin() + result.offsets[i]);
+      },
+      size_t{256});
+  return result;
+}
+
+}  // namespace ensketch::sandbox
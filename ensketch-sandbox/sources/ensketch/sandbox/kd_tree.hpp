@@ -0,0 +1,120 @@
+#pragma once
+#include <ensketch/sandbox/aabb.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+
+namespace ensketch::sandbox {
+
+/// Static kd-tree over points, like the vertices of a polyhedral surface.
+/// Every inner node splits its points at the median along the longest axis
+/// of their bounding box. So, the tree is balanced and its depth is
+/// logarithmic in the number of points. Nodes are stored in a single array
+/// in which the two children of an inner node are adjacent and every node
+/// keeps the tight bounding box of its points for pruning. The points are
+/// copied in tree order such that every leaf references a consecutive range.
+///
+struct kd_tree {
+  /// Balanced trees over 32-bit indices never get deeper.
+  /// Hence, traversals may use fixed-size stacks.
+  ///
+  static constexpr size_t max_depth = 64;
+  static constexpr size_t max_leaf_size = 8;
+
+  struct node {
+    bool is_leaf() const noexcept { return count > 0; }
+
+    aabb3 box{};
+    // Index of the first child for inner nodes and
+    // index of the first point in `points` for leaves.
+    uint32 offset{};
+    // Number of points for leaves and zero for inner nodes.
+    uint32 count{};
+  };
+
+  /// Result of a query with the index of the point in the original order
+  /// and its Euclidean distance to the query point. The default value
+  /// marks that no point has been found.
+  ///
+  struct neighbor {
+    operator bool() const noexcept { return index != invalid; }
+
+    static constexpr uint32 invalid = -1;
+    uint32 index = invalid;
+    float32 distance = infinity;
+  };
+
+  bool empty() const noexcept { return nodes.empty(); }
+  auto root() const noexcept -> const node& { return nodes.front(); }
+  auto size() const noexcept -> size_t { return points.size(); }
+
+  vector<node> nodes{};
+  // Points in tree order and their indices in the original order.
+  vector<vec3> points{};
+  vector<uint32> indices{};
+};
+
+/// Constructor Extension for kd-Tree
+/// Build the kd-tree over the given points. Independent subtrees
+/// of large nodes are built concurrently. Point `i` is reported
+/// by the index `i` in the results of all queries.
+///
+auto kd_tree_from(std::span<const vec3> points) -> kd_tree;
+
+/// Constructor Extension for kd-Tree
+/// Build the kd-tree over the vertex positions of a polyhedral surface.
+/// Queries then report vertex IDs.
+///
+auto kd_tree_from(const polyhedral_surface& surface) -> kd_tree;
+
+/// Return the point of the tree closest to `p`. Equal distances
+/// are resolved in favor of the smaller index. The expected time is
+/// logarithmic in the number of points for reasonably distributed points.
+///
+auto nearest(const kd_tree& tree, const vec3& p) noexcept -> kd_tree::neighbor;
+
+/// Return the `k` points of the tree closest to `p` ordered by distance.
+/// Less than `k` points are returned if the tree is smaller.
+///
+auto nearest(const kd_tree& tree, const vec3& p, size_t k)
+    -> vector<kd_tree::neighbor>;
+
+/// Return all points of the tree whose distance to `p`
+/// is at most `radius` ordered by distance.
+///
+auto within(const kd_tree& tree, const vec3& p, float32 radius)
+    -> vector<kd_tree::neighbor>;
+
+/// Answer the nearest-point query for every given point in parallel.
+/// The results are returned in the order of the given points.
+///
+auto nearest(const kd_tree& tree, std::span<const vec3> queries)
+    -> vector<kd_tree::neighbor>;
+
+/// Answer the k-nearest-neighbors query for every given point in parallel.
+/// The `k` results of query `i` are stored ordered by distance starting at
+/// index `i * k`. Missing neighbors of small trees are left invalid.
+///
+auto nearest(const kd_tree& tree, std::span<const vec3> queries, size_t k)
+    -> vector<kd_tree::neighbor>;
+
+/// Results of batched radius queries in compressed form.
+/// The neighbors of query `i` are stored in the range
+/// from `offsets[i]` to `offsets[i + 1]`.
+///
+struct kd_tree_neighborhoods {
+  auto size() const noexcept -> size_t { return offsets.size() - 1; }
+  auto operator[](size_t i) const noexcept
+      -> std::span<const kd_tree::neighbor> {
+    return {neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1]};
+  }
+
+  vector<size_t> offsets{0};
+  vector<kd_tree::neighbor> neighbors{};
+};
+
+/// Answer the radius query for every given point in parallel.
+///
+auto within(const kd_tree& tree,
+            std::span<const vec3> queries,
+            float32 radius) -> kd_tree_neighborhoods;
+
+}  // namespace ensketch::sandbox
@@ -1,5 +1,6 @@
 #include <ensketch/luarepl/luarepl.hpp>
 #include <ensketch/sandbox/basic_viewer.hpp>
+#include <ensketch/sandbox/cpu_renderer.hpp>
 #include <ensketch/sandbox/executor.hpp>
 #include <ensketch/sandbox/log.hpp>
 #include <ensketch/sandbox/scene_viewer.hpp>
@@ -48,6 +49,29 @@ void add_lua_functions() {
       fn<"print", "Print a given string to the REPL log.">(
           [](czstring str) { luarepl::log(str); }),
 
+      fn<"render_surface",
+         "Render a surface mesh from file to a PNG image on the CPU. "
+         "No OpenGL context or display is needed.">(
+          [](const string& surface_path, const string& image_path, int width,
+             int height, bool wireframe) {
+            const auto surface = polyhedral_surface_from(surface_path);
+            const auto tree = bvh_from(surface);
+
+            // Look at the whole surface like the viewer after loading it.
+            //
+            const auto box = aabb_from(surface);
+            opengl::camera camera{};
+            camera.set_screen_resolution(width, height);
+            const auto radius = box.radius() / tan(0.5f * camera.vfov());
+            camera.move(box.origin() + vec3{0, 0, radius})
+                .look_at(box.origin(), {0, 1, 0})
+                .set_near_and_far(1e-4f * radius, 2 * radius);
+
+            cpu_render_options options{};
+            options.wireframe = wireframe;
+            store_png(render(camera, surface, tree, options), image_path);
+          }),
+
       // fn<"open_viewer", "Open the viewer with an OpenGL context.">(
       //     [](int width, int height) { open_viewer(width, height); }),
 
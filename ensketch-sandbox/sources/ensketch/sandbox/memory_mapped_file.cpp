@@ -0,0 +1,109 @@
+#include <ensketch/sandbox/memory_mapped_file.hpp>
+//
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ensketch::sandbox {
+
+memory_mapped_file::memory_mapped_file(const std::filesystem::path& path) {
+  // Generate functor for prefixed error messages.
+  const auto throw_error = [&](czstring str) {
+    throw std::runtime_error(std::format(
+        "Failed to map file '{}' into memory. {}", path.string(), str));
+  };
+
+#if defined(_WIN32)
+  const auto file =
+      CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    throw_error("The file could not be opened.");
+
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    throw_error("The file size could not be determined.");
+  }
+  _size = static_cast<size_t>(size.QuadPart);
+  if (_size == 0) {
+    CloseHandle(file);
+    return;
+  }
+
+  // The view keeps the mapping alive.
+  // So, both handles can be closed right after mapping.
+  const auto mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping) throw_error("The file mapping could not be created.");
+  _data = static_cast<const char*>(
+      MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  CloseHandle(mapping);
+  if (!_data) {
+    _size = 0;
+    throw_error("The file view could not be mapped.");
+  }
+#else
+  const auto file = ::open(path.c_str(), O_RDONLY);
+  if (file == -1) throw_error("The file could not be opened.");
+
+  struct stat info {};
+  if (::fstat(file, &info) == -1) {
+    ::close(file);
+    throw_error("The file size could not be determined.");
+  }
+  _size = static_cast<size_t>(info.st_size);
+  if (_size == 0) {
+    ::close(file);
+    return;
+  }
+
+  // The mapping stays valid after closing the file descriptor.
+  const auto data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+  ::close(file);
+  if (data == MAP_FAILED) {
+    _size = 0;
+    throw_error("The call to 'mmap' failed.");
+  }
+  _data = static_cast<const char*>(data);
+
+  // All parsers in this project read their input front to back.
+  ::madvise(data, _size, MADV_SEQUENTIAL);
+#endif
+}
+
+memory_mapped_file::~memory_mapped_file() noexcept {
+  unmap();
+}
+
+memory_mapped_file::memory_mapped_file(memory_mapped_file&& x) noexcept
+    : _data{std::exchange(x._data, nullptr)},
+      _size{std::exchange(x._size, 0)} {}
+
+memory_mapped_file& memory_mapped_file::operator=(
+    memory_mapped_file&& x) noexcept {
+  std::swap(_data, x._data);
+  std::swap(_size, x._size);
+  return *this;
+}
+
+void memory_mapped_file::unmap() noexcept {
+  if (!_data) return;
+#if defined(_WIN32)
+  UnmapViewOfFile(_data);
+#else
+  ::munmap(const_cast<char*>(_data), _size);
+#endif
+  _data = nullptr;
+  _size = 0;
+}
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,46 @@
+#pragma once
+#include <ensketch/sandbox/defaults.hpp>
+
+namespace ensketch::sandbox {
+
+/// Read-only memory mapping of a whole file.
+/// The mapping lets the operating system page in the file content on demand
+/// and allows for parsing directly from the page cache without any
+/// intermediate copies through stream buffers.
+/// Empty files are valid and result in an empty mapping.
+///
+class memory_mapped_file {
+ public:
+  memory_mapped_file() noexcept = default;
+
+  /// Map the file given by `path` into memory.
+  /// Throws `std::runtime_error` if the file cannot be opened or mapped.
+  ///
+  explicit memory_mapped_file(const std::filesystem::path& path);
+
+  ~memory_mapped_file() noexcept;
+
+  // Copying is NOT allowed.
+  //
+  memory_mapped_file(const memory_mapped_file&) = delete;
+  memory_mapped_file& operator=(const memory_mapped_file&) = delete;
+
+  // Moving is allowed.
+  //
+  memory_mapped_file(memory_mapped_file&& x) noexcept;
+  memory_mapped_file& operator=(memory_mapped_file&& x) noexcept;
+
+  auto data() const noexcept -> const char* { return _data; }
+  auto size() const noexcept -> size_t { return _size; }
+  bool empty() const noexcept { return _size == 0; }
+
+  auto view() const noexcept -> std::string_view { return {_data, _size}; }
+
+ private:
+  void unmap() noexcept;
+
+  const char* _data = nullptr;
+  size_t _size = 0;
+};
+
+}  // namespace ensketch::sandbox
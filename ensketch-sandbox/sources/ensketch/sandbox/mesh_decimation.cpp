@@ -0,0 +1,464 @@
+#include <ensketch/sandbox/mesh_decimation.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+using vertex_id = surface_decimation::vertex_id;
+using face_id = surface_decimation::face_id;
+using halfedge_id = halfedge_connectivity::halfedge_id;
+using quadric = surface_decimation::quadric;
+
+constexpr auto invalid = halfedge_connectivity::invalid;
+constexpr auto no_collapse = ~uint64{0};
+
+// Reciprocal of the fraction of edges considered in every round.
+//
+constexpr size_t candidate_fraction = 4;
+
+// Bijective pseudo-random permutation of 32-bit integers.
+//
+constexpr auto scramble(uint32 x) noexcept -> uint32 {
+  x *= 0x9e3779b1u;
+  x ^= x >> 16;
+  x *= 0x85ebca6bu;
+  x ^= x >> 13;
+  return x;
+}
+
+auto source(const auto& faces, halfedge_id h) noexcept -> vertex_id {
+  return faces[h / 3][h % 3];
+}
+
+auto target(const auto& faces, halfedge_id h) noexcept -> vertex_id {
+  return faces[h / 3][(h % 3 == 2) ? 0 : h % 3 + 1];
+}
+
+// Every undirected edge is represented by exactly one of its halfedges.
+// Boundary edges only have one and interior edges use the halfedge
+// that runs from the smaller to the larger vertex.
+//
+auto representative(const auto& faces,
+                    const halfedge_connectivity& c,
+                    halfedge_id h) noexcept -> halfedge_id {
+  const auto t = c.twin(h);
+  if ((t == invalid) || (source(faces, h) < target(faces, h))) return h;
+  return t;
+}
+
+// Quadric of the squared distance to the plane
+// through `p` with unit normal `n` scaled by `weight`.
+//
+auto quadric_from_plane(const vec3& n, const vec3& p, float64 weight) noexcept
+    -> quadric {
+  const float64 a = n.x;
+  const float64 b = n.y;
+  const float64 c = n.z;
+  const float64 d = -(a * p.x + b * p.y + c * p.z);
+  const auto w = weight;
+  return {{w * a * a, w * a * b, w * a * c, w * a * d, w * b * b, w * b * c,
+           w * b * d, w * c * c, w * c * d, w * d * d}};
+}
+
+// Return the point that minimizes the quadric by Cramer's rule
+// if the system is well-conditioned. Quadrics of nearly planar
+// or straight regions have no unique minimizer.
+//
+auto minimizer(const quadric& q) noexcept -> optional<vec3> {
+  const auto& m = q.coefficients;
+  const auto adj00 = m[4] * m[7] - m[5] * m[5];
+  const auto adj01 = m[2] * m[5] - m[1] * m[7];
+  const auto adj02 = m[1] * m[5] - m[2] * m[4];
+  const auto det = m[0] * adj00 + m[1] * adj01 + m[2] * adj02;
+  const auto scale = std::max({m[0], m[4], m[7]});
+  if (!(std::abs(det) > 1e-8 * scale * scale * scale)) return nullopt;
+  const auto adj11 = m[0] * m[7] - m[2] * m[2];
+  const auto adj12 = m[1] * m[2] - m[0] * m[5];
+  const auto adj22 = m[0] * m[4] - m[1] * m[1];
+  const auto r0 = -m[3];
+  const auto r1 = -m[6];
+  const auto r2 = -m[8];
+  return vec3{float32((adj00 * r0 + adj01 * r1 + adj02 * r2) / det),
+              float32((adj01 * r0 + adj11 * r1 + adj12 * r2) / det),
+              float32((adj02 * r0 + adj12 * r1 + adj22 * r2) / det)};
+}
+
+// Gather all vertices that share a face with `v` in sorted order.
+//
+void load_ring(const auto& faces,
+               const halfedge_connectivity& c,
+               vertex_id v,
+               vector<vertex_id>& ring) {
+  ring.clear();
+  for (auto h : c.outgoing(v)) {
+    ring.push_back(target(faces, h));
+    ring.push_back(target(faces, halfedge_connectivity::next(h)));
+  }
+  std::ranges::sort(ring);
+  const auto [first, last] = std::ranges::unique(ring);
+  ring.erase(first, last);
+}
+
+}  // namespace
+
+auto surface_decimation::quadric::operator()(const vec3& p) const noexcept
+    -> float64 {
+  const auto& m = coefficients;
+  const float64 x = p.x;
+  const float64 y = p.y;
+  const float64 z = p.z;
+  return x * (m[0] * x + 2 * (m[1] * y + m[2] * z + m[3])) +
+         y * (m[4] * y + 2 * (m[5] * z + m[6])) + z * (m[7] * z + 2 * m[8]) +
+         m[9];
+}
+
+surface_decimation::surface_decimation(const polyhedral_surface& surface,
+                                       const decimation_options& options)
+    : options{options}, faces{surface.faces} {
+  const auto n = surface.vertices.size();
+  positions.resize(n);
+  parents.resize(n);
+  parallel_for(n, [&](size_t v) {
+    positions[v] = surface.vertices[v].position;
+    parents[v] = v;
+  });
+  connectivity = halfedge_connectivity_from(faces, n);
+  generate_quadrics();
+}
+
+void surface_decimation::generate_quadrics() {
+  const auto& c = connectivity;
+  quadrics.assign(positions.size(), {});
+  // Every vertex gathers the planes of its own faces. So, no
+  // quadric is written by more than one thread.
+  //
+  parallel_for(positions.size(), [&](size_t v) {
+    auto& q = quadrics[v];
+    for (auto h : c.outgoing(v)) {
+      const auto& f = faces[halfedge_connectivity::face(h)];
+      const auto& p = positions[f[0]];
+      const auto normal = cross(positions[f[1]] - p, positions[f[2]] - p);
+      const auto area = length(normal);
+      if (area == 0) continue;
+      const auto n = normal / area;
+      q += quadric_from_plane(n, p, 0.5 * area);
+
+      // Planes perpendicular to the face keep boundary edges in place.
+      //
+      for (auto e : {h, halfedge_connectivity::prev(h)}) {
+        if (c.twin(e) != invalid) continue;
+        const auto& s = positions[source(faces, e)];
+        const auto d = positions[target(faces, e)] - s;
+        const auto m = cross(d, n);
+        const auto l = length(m);
+        if (l == 0) continue;
+        q += quadric_from_plane(m / l, s, options.boundary_weight * dot(d, d));
+      }
+    }
+  });
+}
+
+auto surface_decimation::optimal_position(halfedge_id h) const noexcept
+    -> vec3 {
+  const auto a = source(faces, h);
+  const auto b = target(faces, h);
+  auto q = quadrics[a];
+  q += quadrics[b];
+
+  // The minimizer is only trusted close to the edge.
+  // Otherwise, the best of the end points and the midpoint is used.
+  //
+  const auto& p = positions[a];
+  const auto& r = positions[b];
+  const auto mid = 0.5f * (p + r);
+  auto result = mid;
+  auto error = q(mid);
+  const auto x = minimizer(q);
+  if (x && (distance(*x, mid) <= distance(p, r))) {
+    result = *x;
+    error = q(*x);
+  }
+  for (const auto& y : {p, r}) {
+    const auto e = q(y);
+    if (e < error) {
+      result = y;
+      error = e;
+    }
+  }
+  return result;
+}
+
+auto surface_decimation::collapse_round(size_t max_collapses) -> size_t {
+  const auto& c = connectivity;
+  const auto vertex_count = positions.size();
+  const auto halfedge_count = 3 * faces.size();
+
+  vector<uint8> boundary(vertex_count, 0);
+  parallel_for(vertex_count, [&](size_t v) {
+    for (auto h : c.outgoing(v))
+      if ((c.twin(h) == invalid) ||
+          (c.twin(halfedge_connectivity::prev(h)) == invalid))
+        boundary[v] = 1;
+  });
+
+  // Forbid collapses of non-manifold edges
+  // and of interior edges between two boundary vertices.
+  //
+  const auto admissible = [&](halfedge_id h) {
+    const auto a = source(faces, h);
+    const auto b = target(faces, h);
+    if (a == b) return false;
+    const bool boundary_edge = c.twin(h) == invalid;
+    if (boundary[a] && boundary[b] && !boundary_edge) return false;
+    return (std::ranges::count(c.targets_of(a), b) == 1) &&
+           (std::ranges::count(c.targets_of(b), a) == !boundary_edge);
+  };
+
+  // Check the link condition. Both vertices must only share the
+  // opposite vertices of the faces of the edge as neighbors.
+  //
+  const auto linked = [&](halfedge_id h, vector<vertex_id>& ring_a,
+                          vector<vertex_id>& ring_b) {
+    load_ring(faces, c, source(faces, h), ring_a);
+    load_ring(faces, c, target(faces, h), ring_b);
+    size_t common = 0;
+    for (size_t i = 0, j = 0; (i < ring_a.size()) && (j < ring_b.size());) {
+      if (ring_a[i] < ring_b[j])
+        ++i;
+      else if (ring_b[j] < ring_a[i])
+        ++j;
+      else {
+        ++common;
+        ++i;
+        ++j;
+      }
+    }
+    return common == ((c.twin(h) == invalid) ? 1 : 2);
+  };
+
+  // Check whether any remaining face around the edge
+  // degenerates or rotates too much if its vertices move to `p`.
+  //
+  const auto flips = [&](vertex_id a, vertex_id b, const vec3& p) {
+    for (auto v : {a, b}) {
+      for (auto h : c.outgoing(v)) {
+        const auto& f = faces[halfedge_connectivity::face(h)];
+        if ((std::ranges::count(f, a) + std::ranges::count(f, b)) > 1)
+          continue;
+        array<vec3, 3> x{positions[f[0]], positions[f[1]], positions[f[2]]};
+        const auto n0 = cross(x[1] - x[0], x[2] - x[0]);
+        const auto l0 = length(n0);
+        if (l0 == 0) continue;
+        x[std::ranges::find(f, v) - f.begin()] = p;
+        const auto n1 = cross(x[1] - x[0], x[2] - x[0]);
+        if (dot(n0, n1) <= options.min_normal_cosine * l0 * length(n1))
+          return true;
+      }
+    }
+    return false;
+  };
+
+  // Evaluate the costs of all admissible edges.
+  //
+  constexpr auto no_cost = std::numeric_limits<float32>::infinity();
+  vector<float32> costs(halfedge_count, no_cost);
+  parallel_for(halfedge_count, [&](halfedge_id h) {
+    if (representative(faces, c, h) != h) return;
+    if (!admissible(h)) return;
+    const auto p = optimal_position(h);
+    auto q = quadrics[source(faces, h)];
+    q += quadrics[target(faces, h)];
+    costs[h] = float32(std::max(q(p), 0.0));
+  });
+
+  // Only the cheapest fraction of the edges are candidates. Among them,
+  // keys are a bijective hash of the index instead of the cost. Costs
+  // vary smoothly over most surfaces and minimal costs would only be
+  // found in few places. Random keys give many independent collapses.
+  //
+  vector<float32> sorted{};
+  for (auto x : costs)
+    if (x != no_cost) sorted.push_back(x);
+  if (sorted.empty()) return 0;
+  const auto quantile = std::min(sorted.size() - 1,
+                                 std::max(sorted.size() / candidate_fraction,
+                                          2 * max_collapses));
+  std::ranges::nth_element(sorted, sorted.begin() + quantile);
+  const auto threshold = sorted[quantile];
+  vector<uint64> keys(halfedge_count, no_collapse);
+  parallel_for(halfedge_count, [&](halfedge_id h) {
+    if (costs[h] <= threshold) keys[h] = scramble(h);
+  });
+
+  // Only selected edges are checked for topology and flips. Rejected
+  // edges are dropped and the selection is repeated a few times
+  // to give their neighbors a chance.
+  //
+  vector<uint64> vertex_keys(vertex_count);
+  vector<uint64> region_keys(vertex_count);
+  vector<halfedge_id> selection{};
+  vector<uint8> rejected{};
+  vector<uint8> validated(halfedge_count, 0);
+  constexpr int max_selections = 4;
+  for (int i = 0; i < max_selections; ++i) {
+    // The minimal key of all edges around every vertex
+    // and afterwards around all vertices of its faces.
+    //
+    parallel_for(vertex_count, [&](size_t v) {
+      auto k = no_collapse;
+      for (auto h : c.outgoing(v)) {
+        k = std::min(k, keys[representative(faces, c, h)]);
+        const auto p = halfedge_connectivity::prev(h);
+        k = std::min(k, keys[representative(faces, c, p)]);
+      }
+      vertex_keys[v] = k;
+    });
+    parallel_for(vertex_count, [&](size_t v) {
+      auto k = vertex_keys[v];
+      for (auto h : c.outgoing(v)) {
+        const auto n = halfedge_connectivity::next(h);
+        k = std::min(k, vertex_keys[target(faces, h)]);
+        k = std::min(k, vertex_keys[target(faces, n)]);
+      }
+      region_keys[v] = k;
+    });
+
+    selection.clear();
+    for (halfedge_id h = 0; h < halfedge_count; ++h) {
+      const auto k = keys[h];
+      if ((k != no_collapse) && (k == region_keys[source(faces, h)]) &&
+          (k == region_keys[target(faces, h)]))
+        selection.push_back(h);
+    }
+
+    rejected.assign(selection.size(), 0);
+    parallel_for_chunks(selection.size(), [&](size_t first, size_t last) {
+      vector<vertex_id> ring_a{};
+      vector<vertex_id> ring_b{};
+      for (auto j = first; j < last; ++j) {
+        const auto h = selection[j];
+        if (validated[h]) continue;
+        validated[h] = 1;
+        if (linked(h, ring_a, ring_b) &&
+            !flips(source(faces, h), target(faces, h), optimal_position(h)))
+          continue;
+        rejected[j] = 1;
+        keys[h] = no_collapse;
+      }
+    }, 256);
+
+    size_t count = 0;
+    for (size_t j = 0; j < selection.size(); ++j)
+      if (!rejected[j]) selection[count++] = selection[j];
+    const bool done = count == selection.size();
+    selection.resize(count);
+    if (done) break;
+  }
+
+  if (selection.size() > max_collapses) {
+    std::ranges::nth_element(selection, selection.begin() + max_collapses,
+                             {}, [&](halfedge_id h) { return costs[h]; });
+    selection.resize(max_collapses);
+  }
+
+  // Selected edges share no faces. So, all collapses run in parallel.
+  // The first vertex of every edge is kept and the second one is removed.
+  //
+  vector<uint8> removed(faces.size(), 0);
+  parallel_for(selection.size(), [&](size_t i) {
+    const auto h = selection[i];
+    const auto a = source(faces, h);
+    const auto b = target(faces, h);
+    const auto p = optimal_position(h);
+    positions[a] = p;
+    quadrics[a] += quadrics[b];
+    parents[b] = a;
+    for (auto e : c.outgoing(b)) {
+      const auto f = halfedge_connectivity::face(e);
+      if (std::ranges::count(faces[f], a)) {
+        removed[f] = 1;
+        continue;
+      }
+      for (auto& v : faces[f])
+        if (v == b) v = a;
+    }
+  });
+
+  size_t count = 0;
+  for (size_t f = 0; f < faces.size(); ++f)
+    if (!removed[f]) faces[count++] = faces[f];
+  faces.resize(count);
+  connectivity = halfedge_connectivity_from(faces, vertex_count);
+  return selection.size();
+}
+
+auto surface_decimation::collapse(size_t target) -> size_t {
+  size_t rounds = 0;
+  while (faces.size() > target) {
+    // Every interior collapse removes two faces.
+    const auto max_collapses = (faces.size() - target + 1) / 2;
+    if (collapse_round(max_collapses) == 0) break;
+    ++rounds;
+  }
+  return rounds;
+}
+
+auto surface_decimation::lod() const -> surface_lod {
+  const auto n = positions.size();
+  surface_lod result{};
+
+  // Vertices that have not been removed keep their relative order.
+  //
+  vector<uint32> ids(n);
+  parallel_for(n, [&](size_t v) { ids[v] = (parents[v] == v); });
+  const auto count = parallel_exclusive_scan(std::span{ids});
+  result.origins.resize(count);
+  result.vertex_map.resize(n);
+  auto& surface = result.surface;
+  surface.vertices.resize(count);
+  parallel_for(n, [&](size_t v) {
+    auto root = v;
+    while (parents[root] != root) root = parents[root];
+    result.vertex_map[v] = ids[root];
+    if (root != v) return;
+    result.origins[ids[v]] = v;
+    surface.vertices[ids[v]].position = positions[v];
+  });
+
+  surface.faces.resize(faces.size());
+  parallel_for(faces.size(), [&](size_t f) {
+    for (size_t k = 0; k < 3; ++k) surface.faces[f][k] = ids[faces[f][k]];
+  });
+  surface.generate_edges();
+
+  parallel_for(count, [&](size_t v) {
+    vec3 normal{};
+    for (auto h : surface.connectivity.outgoing(v)) {
+      const auto& f = surface.faces[halfedge_connectivity::face(h)];
+      const auto& p = surface.vertices[f[0]].position;
+      normal += cross(surface.vertices[f[1]].position - p,
+                      surface.vertices[f[2]].position - p);
+    }
+    const auto l = length(normal);
+    surface.vertices[v].normal = (l > 0) ? normal / l : normal;
+  });
+  return result;
+}
+
+auto surface_lods_from(const polyhedral_surface& surface,
+                       const decimation_options& options)
+    -> vector<surface_lod> {
+  vector<surface_lod> result{};
+  surface_decimation decimation{surface, options};
+  auto target = size_t(options.ratio * surface.faces.size());
+  while (target >= options.min_face_count) {
+    const auto count = decimation.face_count();
+    decimation.collapse(target);
+    if (decimation.face_count() == count) break;
+    result.push_back(decimation.lod());
+    target = size_t(options.ratio * decimation.face_count());
+  }
+  return result;
+}
+
+}  // namespace ensketch::sandbox
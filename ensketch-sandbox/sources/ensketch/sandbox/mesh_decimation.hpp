@@ -0,0 +1,103 @@
+#pragma once
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+
+namespace ensketch::sandbox {
+
+/// Coarse level of detail (LOD) of a surface with generated edges.
+/// Every vertex of the full-resolution surface is mapped to the vertex
+/// of the LOD that it has been collapsed into. Every vertex of the LOD has
+/// been kept from a vertex of the full-resolution surface, its origin.
+/// So, curves and scalar fields can be moved between both resolutions.
+///
+struct surface_lod {
+  polyhedral_surface surface{};
+  vector<uint32> vertex_map{};
+  vector<uint32> origins{};
+};
+
+struct decimation_options {
+  /// Ratio of the face counts of two consecutive LODs.
+  float32 ratio = 0.25f;
+  /// The chain stops before LODs would get fewer faces.
+  size_t min_face_count = 1000;
+  /// Collapses must not rotate the normal of any remaining
+  /// face by more than the angle with this cosine.
+  float32 min_normal_cosine = 0.2f;
+  /// Weight of the planes that keep boundaries in place
+  /// relative to the planes of the faces.
+  float32 boundary_weight = 100.0f;
+};
+
+/// Quadric error simplification of a triangle surface by edge collapses.
+/// Every vertex accumulates the quadrics of the planes of its faces and
+/// its boundary edges weighted by their area. Collapsing an edge moves its
+/// remaining vertex to the point that minimizes the sum of both quadrics.
+///
+/// Collapses are carried out in parallel rounds. In every round, the costs
+/// of all edges are evaluated in parallel and the cheapest quarter of them
+/// are candidates. Every candidate whose hashed index is minimal among all
+/// candidates of the faces around both of its vertices is collapsed.
+/// Such edges do not share any face and their collapses are independent.
+/// Edges that would violate the link condition, pinch boundaries,
+/// or flip faces are never collapsed. So, manifold input stays manifold.
+/// The hash does not depend on the thread count. Hence, the result is
+/// deterministic.
+///
+class surface_decimation {
+ public:
+  using vertex_id = polyhedral_surface::vertex_id;
+  using face_id = polyhedral_surface::face_id;
+
+  struct quadric {
+    quadric& operator+=(const quadric& q) noexcept {
+      for (size_t i = 0; i < coefficients.size(); ++i)
+        coefficients[i] += q.coefficients[i];
+      return *this;
+    }
+
+    /// Return the weighted sum of squared distances of `p` to all planes.
+    ///
+    auto operator()(const vec3& p) const noexcept -> float64;
+
+    /// Upper triangle of the symmetric 4x4 matrix in row-major order.
+    array<float64, 10> coefficients{};
+  };
+
+  explicit surface_decimation(const polyhedral_surface& surface,
+                              const decimation_options& options = {});
+
+  auto face_count() const noexcept -> size_t { return faces.size(); }
+
+  /// Collapse edges until at most `target` faces are left or no edge
+  /// can be collapsed anymore. Return the number of rounds.
+  ///
+  auto collapse(size_t target) -> size_t;
+
+  /// Return the current surface as LOD of the initial surface.
+  /// Vertex normals are averaged from the remaining faces.
+  ///
+  auto lod() const -> surface_lod;
+
+ private:
+  void generate_quadrics();
+  auto optimal_position(halfedge_connectivity::halfedge_id h) const noexcept
+      -> vec3;
+  auto collapse_round(size_t max_collapses) -> size_t;
+
+  decimation_options options{};
+  vector<vec3> positions{};
+  vector<polyhedral_surface::face> faces{};
+  vector<quadric> quadrics{};
+  vector<vertex_id> parents{};
+  halfedge_connectivity connectivity{};
+};
+
+/// Construct a chain of LODs from fine to coarse. Every LOD continues
+/// the decimation of its predecessor. So, the whole chain costs
+/// little more than decimating the surface to the coarsest LOD once.
+///
+auto surface_lods_from(const polyhedral_surface& surface,
+                       const decimation_options& options = {})
+    -> vector<surface_lod>;
+
+}  // namespace ensketch::sandbox
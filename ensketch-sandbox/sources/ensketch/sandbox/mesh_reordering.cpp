@@ -0,0 +1,173 @@
+#include <ensketch/sandbox/mesh_reordering.hpp>
+//
+#include <ensketch/sandbox/morton.hpp>
+#include <ensketch/sandbox/parallel.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+// Return the elements of the range in the order of the permutation.
+//
+auto permuted(const auto& values, const permutation& p) {
+  using value_type = std::ranges::range_value_t<decltype(values)>;
+  vector<value_type> result(p.size());
+  parallel_for(p.size(), [&](size_t i) { result[i] = values[p.order[i]]; });
+  return result;
+}
+
+// Append the new orders of the vertices and faces of one group to
+// the given orders. The vertices of the group start at `vertex_offset`
+// and the faces of the group do not reference any other vertices.
+//
+void append_group_order(std::span<const vec3> positions,
+                        const auto& faces,
+                        uint32 vertex_offset,
+                        uint32 face_offset,
+                        vector<uint32>& vertex_order,
+                        vector<uint32>& face_order) {
+  const auto vertices = permutation_from(spatial_vertex_order(positions));
+  vector<array<uint32, 3>> local_faces(std::ranges::size(faces));
+  parallel_for(local_faces.size(), [&](size_t f) {
+    for (size_t k = 0; k < 3; ++k)
+      local_faces[f][k] = vertices.map[faces[f][k] - vertex_offset];
+  });
+  for (auto v : vertices.order) vertex_order.push_back(vertex_offset + v);
+  for (auto f : vertex_cache_face_order(local_faces, positions.size()))
+    face_order.push_back(face_offset + f);
+}
+
+// Renumber the vertex indices of the faces and reorder the faces.
+//
+void reorder_faces(auto& faces, const mesh_reordering& reordering) {
+  const auto& map = reordering.vertices.map;
+  auto result = permuted(faces, reordering.faces);
+  parallel_for(result.size(), [&](size_t f) {
+    for (auto& v : result[f]) v = map[v];
+  });
+  faces = std::move(result);
+}
+
+}  // namespace
+
+auto permutation_from(vector<uint32> order) -> permutation {
+  permutation result{std::move(order)};
+  result.map.resize(result.size());
+  parallel_for(result.size(),
+               [&](size_t i) { result.map[result.order[i]] = i; });
+  return result;
+}
+
+auto spatial_vertex_order(std::span<const vec3> positions) -> vector<uint32> {
+  const auto n = positions.size();
+  vector<uint32> order(n);
+  if (n == 0) return order;
+
+  // All axes are scaled uniformly. So, the cells of the grid are cubes.
+  //
+  const auto box = aabb_from(positions);
+  const auto size = box._max - box._min;
+  const auto extent = std::max({size.x, size.y, size.z});
+  const auto scale = (extent > 0) ? 1023.0f / extent : 0.0f;
+
+  vector<uint32> keys(n);
+  parallel_for(n, [&](size_t i) {
+    const auto x = (positions[i] - box._min) * scale;
+    keys[i] = morton_code(uint32(x.x), uint32(x.y), uint32(x.z));
+    order[i] = i;
+  });
+  parallel_radix_sort(keys, order, 30);
+  return order;
+}
+
+auto reorder(polyhedral_surface& surface) -> mesh_reordering {
+  const auto vertex_count = surface.vertices.size();
+  mesh_reordering result{};
+  result.acmr_before = average_cache_miss_ratio(surface.faces, vertex_count);
+
+  vector<vec3> positions(vertex_count);
+  parallel_for(vertex_count,
+               [&](size_t v) { positions[v] = surface.vertices[v].position; });
+  vector<uint32> vertex_order{};
+  vector<uint32> face_order{};
+  vertex_order.reserve(vertex_count);
+  face_order.reserve(surface.faces.size());
+  append_group_order(positions, surface.faces, 0, 0, vertex_order, face_order);
+  result.vertices = permutation_from(std::move(vertex_order));
+  result.faces = permutation_from(std::move(face_order));
+
+  surface.vertices = permuted(surface.vertices, result.vertices);
+  if (surface.ambient_occlusion.size() == vertex_count)
+    surface.ambient_occlusion =
+        permuted(surface.ambient_occlusion, result.vertices);
+  reorder_faces(surface.faces, result);
+
+  // Connectivity and one-rings refer to halfedges of faces.
+  // So, they are only valid if they are built again.
+  //
+  if (surface.connectivity.offsets.size() > 1) {
+    surface.generate_edges();
+  } else {
+    surface.neighbor_count.clear();
+    surface.mean_edge_length.clear();
+    surface.max_edge_length.clear();
+  }
+
+  result.acmr_after = average_cache_miss_ratio(surface.faces, vertex_count);
+  return result;
+}
+
+auto reorder(skinned_mesh& mesh) -> mesh_reordering {
+  const auto vertex_count = mesh.vertices.size();
+  mesh_reordering result{};
+  result.acmr_before = average_cache_miss_ratio(mesh.faces, vertex_count);
+
+  vector<uint32> vertex_order{};
+  vector<uint32> face_order{};
+  vertex_order.reserve(vertex_count);
+  face_order.reserve(mesh.faces.size());
+  vector<vec3> positions{};
+  for (size_t g = 0; g + 1 < mesh.group_offsets.size(); ++g) {
+    const auto first = mesh.group_offsets[g];
+    const auto last = mesh.group_offsets[g + 1];
+    positions.resize(last.vertex - first.vertex);
+    for (size_t v = 0; v < positions.size(); ++v)
+      positions[v] = mesh.vertices[first.vertex + v].position;
+    const std::span faces{mesh.faces.data() + first.face,
+                          mesh.faces.data() + last.face};
+    append_group_order(positions, faces, first.vertex, first.face,
+                       vertex_order, face_order);
+  }
+  result.vertices = permutation_from(std::move(vertex_order));
+  result.faces = permutation_from(std::move(face_order));
+
+  mesh.vertices = permuted(mesh.vertices, result.vertices);
+  reorder_faces(mesh.faces, result);
+
+  // The rows of the weight matrix are moved
+  // like the vertices by counting them again.
+  //
+  auto& weights = mesh.weights;
+  if (weights.offsets.size() == vertex_count + 1) {
+    weight_matrix w{};
+    w.offsets.assign(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; ++v) {
+      const auto old = result.vertices.order[v];
+      w.offsets[v + 1] =
+          w.offsets[v] + weights.offsets[old + 1] - weights.offsets[old];
+    }
+    w.entries.resize(w.offsets.back());
+    parallel_for(vertex_count, [&](size_t v) {
+      const auto old = result.vertices.order[v];
+      std::copy(weights.entries.begin() + weights.offsets[old],
+                weights.entries.begin() + weights.offsets[old + 1],
+                w.entries.begin() + w.offsets[v]);
+    });
+    weights = std::move(w);
+  }
+
+  result.acmr_after = average_cache_miss_ratio(mesh.faces, vertex_count);
+  return result;
+}
+
+}  // namespace ensketch::sandbox
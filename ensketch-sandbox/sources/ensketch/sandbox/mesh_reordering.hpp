@@ -0,0 +1,174 @@
+#pragma once
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+#include <ensketch/sandbox/skinned_mesh.hpp>
+
+namespace ensketch::sandbox {
+
+/// Number of entries of the simulated post-transform vertex cache.
+/// Typical GPUs behave like FIFO caches of this size or larger.
+///
+constexpr size_t default_vertex_cache_size = 16;
+
+/// Bijective renumbering of elements, like vertices or faces.
+/// `order[i]` is the old index of the new element `i`
+/// and `map[j]` is the new index of the old element `j`.
+///
+struct permutation {
+  auto size() const noexcept -> size_t { return order.size(); }
+
+  vector<uint32> order{};
+  vector<uint32> map{};
+};
+
+/// Constructor Extension for Permutation
+/// The inverse map is computed in parallel.
+///
+auto permutation_from(vector<uint32> order) -> permutation;
+
+/// Result of reordering a mesh. Curves, selections, and per-vertex or
+/// per-face data of the old mesh are remapped by the permutations.
+/// The average cache miss ratio (ACMR) is the number of vertices that
+/// are transformed per face. It ranges from 0.5 for ideal orders
+/// of large meshes to 3 if vertices are never reused.
+///
+struct mesh_reordering {
+  permutation vertices{};
+  permutation faces{};
+  float32 acmr_before{};
+  float32 acmr_after{};
+};
+
+/// Return the vertices in the order of the three-dimensional Morton codes
+/// of their positions quantized inside their bounding box. Codes are
+/// computed in parallel and sorted by the parallel radix sort.
+///
+auto spatial_vertex_order(std::span<const vec3> positions) -> vector<uint32>;
+
+/// Simulate a FIFO vertex cache of the given size while drawing
+/// the faces in their order and return the average cache miss ratio.
+/// Faces may be given by any random-access range of vertex triples.
+///
+auto average_cache_miss_ratio(const auto& faces,
+                              size_t vertex_count,
+                              size_t cache_size = default_vertex_cache_size)
+    -> float32 {
+  if (std::ranges::empty(faces)) return 0;
+  // A vertex is cached if fewer than `cache_size`
+  // misses happened since its own last miss.
+  vector<size_t> stamps(vertex_count, 0);
+  size_t misses = 0;
+  for (const auto& f : faces) {
+    for (auto v : f) {
+      if ((stamps[v] > 0) && (misses - stamps[v] < cache_size)) continue;
+      stamps[v] = ++misses;
+    }
+  }
+  return float32(misses) / std::ranges::size(faces);
+}
+
+/// Return an order of the faces that reuses the vertices in a post-transform
+/// cache of the given size by the Tipsify algorithm of Sander, Nehab, and
+/// Barczak, 'Fast Triangle Reordering for Vertex Locality and Reduced
+/// Overdraw' (2007). It fans around one vertex after another and chooses
+/// the next vertex among the ones that have just been used such that it
+/// likely still is in the cache. Dead ends continue with the most
+/// recently used vertex and otherwise with the next vertex in index order.
+/// So, vertices in spatial order also give spatially coherent faces.
+/// The run time is linear in the number of faces.
+///
+auto vertex_cache_face_order(const auto& faces,
+                             size_t vertex_count,
+                             size_t cache_size = default_vertex_cache_size)
+    -> vector<uint32> {
+  const auto face_count = std::ranges::size(faces);
+
+  // Adjacent faces of all vertices in CSR format by counting sort.
+  //
+  vector<uint32> offsets(vertex_count + 1, 0);
+  for (const auto& f : faces)
+    for (auto v : f) ++offsets[v + 1];
+  for (size_t v = 0; v < vertex_count; ++v) offsets[v + 1] += offsets[v];
+  vector<uint32> adjacent(offsets.back());
+  {
+    auto fill = offsets;
+    for (uint32 i = 0; const auto& f : faces) {
+      for (auto v : f) adjacent[fill[v]++] = i;
+      ++i;
+    }
+  }
+
+  // Number of faces of every vertex that have not been emitted yet.
+  vector<uint32> live(vertex_count);
+  for (size_t v = 0; v < vertex_count; ++v)
+    live[v] = offsets[v + 1] - offsets[v];
+  vector<size_t> stamps(vertex_count, 0);
+  vector<uint8> emitted(face_count, 0);
+  vector<uint32> dead_ends{};
+  vector<uint32> candidates{};
+  size_t time = cache_size + 1;
+  uint32 cursor = 0;
+
+  vector<uint32> result{};
+  result.reserve(face_count);
+  constexpr auto none = uint32(-1);
+  auto fanning = vertex_count ? uint32{0} : none;
+  while (fanning != none) {
+    candidates.clear();
+    for (auto i = offsets[fanning]; i < offsets[fanning + 1]; ++i) {
+      const auto t = adjacent[i];
+      if (emitted[t]) continue;
+      emitted[t] = 1;
+      result.push_back(t);
+      for (auto v : faces[t]) {
+        dead_ends.push_back(v);
+        candidates.push_back(v);
+        --live[v];
+        if (time - stamps[v] > cache_size) stamps[v] = time++;
+      }
+    }
+
+    // Prefer the vertex that has been in the cache for the longest time
+    // and will not be evicted while its remaining faces are emitted.
+    //
+    fanning = none;
+    size_t priority = 0;
+    for (auto v : candidates) {
+      if (live[v] == 0) continue;
+      size_t p = 0;
+      if (time - stamps[v] + 2 * live[v] <= cache_size) p = time - stamps[v];
+      if ((fanning == none) || (p > priority)) {
+        priority = p;
+        fanning = v;
+      }
+    }
+    if (fanning != none) continue;
+
+    while (!dead_ends.empty()) {
+      const auto v = dead_ends.back();
+      dead_ends.pop_back();
+      if (live[v] > 0) {
+        fanning = v;
+        break;
+      }
+    }
+    if (fanning != none) continue;
+
+    while ((cursor < vertex_count) && (live[cursor] == 0)) ++cursor;
+    if (cursor < vertex_count) fanning = cursor;
+  }
+  return result;
+}
+
+/// Renumber the vertices of the surface in spatial order and reorder
+/// its faces for the vertex cache afterwards. All per-vertex data
+/// is permuted accordingly and the edges are generated again.
+///
+auto reorder(polyhedral_surface& surface) -> mesh_reordering;
+
+/// Reorder the vertices and faces of the skinned mesh inside every group
+/// like a polyhedral surface. Hence, all group offsets stay valid.
+/// The rows of the weight matrix are permuted with the vertices.
+///
+auto reorder(skinned_mesh& mesh) -> mesh_reordering;
+
+}  // namespace ensketch::sandbox
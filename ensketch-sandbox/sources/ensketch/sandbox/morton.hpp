@@ -0,0 +1,46 @@
+#pragma once
+#include <ensketch/sandbox/defaults.hpp>
+
+namespace ensketch::sandbox {
+
+/// Spread the lower 16 bits of `x` such that
+/// there is one zero bit between two consecutive bits.
+///
+constexpr auto morton_spread2(uint32 x) noexcept -> uint32 {
+  x &= 0x0000ffff;
+  x = (x | (x << 8)) & 0x00ff00ff;
+  x = (x | (x << 4)) & 0x0f0f0f0f;
+  x = (x | (x << 2)) & 0x33333333;
+  x = (x | (x << 1)) & 0x55555555;
+  return x;
+}
+
+/// Return the two-dimensional Morton code, also known as Z-order,
+/// of the given coordinates by interleaving their lower 16 bits.
+/// Points that are close in the plane tend to be close in this order.
+///
+constexpr auto morton_code(uint32 x, uint32 y) noexcept -> uint32 {
+  return morton_spread2(x) | (morton_spread2(y) << 1);
+}
+
+/// Spread the lower 10 bits of `x` such that
+/// there are two zero bits between two consecutive bits.
+///
+constexpr auto morton_spread3(uint32 x) noexcept -> uint32 {
+  x &= 0x000003ff;
+  x = (x | (x << 16)) & 0x030000ff;
+  x = (x | (x << 8)) & 0x0300f00f;
+  x = (x | (x << 4)) & 0x030c30c3;
+  x = (x | (x << 2)) & 0x09249249;
+  return x;
+}
+
+/// Return the three-dimensional Morton code
+/// of the given coordinates by interleaving their lower 10 bits.
+///
+constexpr auto morton_code(uint32 x, uint32 y, uint32 z) noexcept -> uint32 {
+  return morton_spread3(x) | (morton_spread3(y) << 1) |
+         (morton_spread3(z) << 2);
+}
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,280 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+//
+#include <ensketch/sandbox/defaults.hpp>
+
+namespace ensketch::sandbox {
+
+/// Return the number of worker threads that the parallel algorithms
+/// in this file will use at most. The value is determined once from
+/// the hardware concurrency and is never smaller than one.
+///
+inline auto thread_count() noexcept -> size_t {
+  static const size_t count =
+      std::max<size_t>(1, std::thread::hardware_concurrency());
+  return count;
+}
+
+namespace detail {
+
+/// Process-wide pool of `thread_count() - 1` worker threads on which all
+/// parallel algorithms in this file run their chunks. Threads are started
+/// once on first use instead of for every call. Calls from within chunks,
+/// from other pool workers, or from unrelated threads all share the same
+/// workers. So, nested parallel algorithms do not oversubscribe the cores.
+///
+/// A job is a number of chunks that are claimed one after another by the
+/// workers and by the thread that submitted the job. The submitting thread
+/// keeps claiming chunks of its own job until none are left and then only
+/// waits for the chunks still running on workers. Hence, jobs always finish,
+/// even if all workers are busy or wait for nested jobs themselves.
+///
+class worker_pool {
+ public:
+  struct job {
+    void (*run)(const void* task, size_t chunk);
+    const void* task;
+    size_t count;
+    size_t next = 0;
+    size_t pending = count;
+  };
+
+  static auto instance() -> worker_pool& {
+    static worker_pool pool{};
+    return pool;
+  }
+
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+
+  ~worker_pool() {
+    {
+      std::scoped_lock lock{mutex};
+      stop = true;
+    }
+    job_available.notify_all();
+  }
+
+  /// Run all chunks of the given job and return when all of them finished.
+  ///
+  void execute(job& j) {
+    std::unique_lock lock{mutex};
+    jobs.push_back(&j);
+    lock.unlock();
+    job_available.notify_all();
+    lock.lock();
+    while (j.next < j.count) run_next(lock, j);
+    job_finished.wait(lock, [&j] { return j.pending == 0; });
+  }
+
+ private:
+  worker_pool() {
+    const auto count = thread_count() - 1;
+    workers.reserve(count);
+    for (size_t i = 0; i < count; ++i) workers.emplace_back([this] { work(); });
+  }
+
+  void work() {
+    std::unique_lock lock{mutex};
+    while (true) {
+      job_available.wait(lock, [this] { return stop || !jobs.empty(); });
+      if (stop) return;
+      run_next(lock, *jobs.front());
+    }
+  }
+
+  // Claim the next chunk of `j`, run it without holding the lock,
+  // and report its completion. The thread that claims the last chunk
+  // removes the job from the queue. So, the queue never references
+  // jobs that have already finished and were destroyed by their owner.
+  //
+  void run_next(std::unique_lock<std::mutex>& lock, job& j) {
+    const auto chunk = j.next++;
+    if (j.next == j.count) jobs.erase(std::ranges::find(jobs, &j));
+    lock.unlock();
+    j.run(j.task, chunk);
+    lock.lock();
+    if (--j.pending == 0) job_finished.notify_all();
+  }
+
+  std::mutex mutex{};
+  std::condition_variable job_available{};
+  std::condition_variable job_finished{};
+  std::deque<job*> jobs{};
+  bool stop = false;
+  // Declared last such that workers are joined before the above is destroyed.
+  std::vector<std::jthread> workers{};
+};
+
+}  // namespace detail
+
+/// Split the index range `[0, size)` into `count` consecutive chunks of almost
+/// equal size and invoke `f(chunk, first, last)` for each of them in parallel.
+/// The chunk boundaries only depend on `size` and `count`. Hence, algorithms
+/// that reduce per-chunk results in chunk order stay deterministic.
+/// Chunks run on the shared `detail::worker_pool` and on the calling thread.
+/// The first exception thrown by any invocation of `f` is re-thrown after all
+/// chunks finished.
+///
+void parallel_chunks(size_t size, size_t count, auto&& f) {
+  if (count == 0) return;
+  const auto first = [size, count](size_t chunk) {
+    return chunk * size / count;
+  };
+  if (count == 1) {
+    std::invoke(f, size_t{0}, size_t{0}, size);
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(count);
+  const auto task = [&](size_t chunk) {
+    try {
+      std::invoke(f, chunk, first(chunk), first(chunk + 1));
+    } catch (...) {
+      errors[chunk] = std::current_exception();
+    }
+  };
+  using task_type = decltype(task);
+  detail::worker_pool::job job{
+      .run =
+          [](const void* task, size_t chunk) {
+            (*static_cast<const task_type*>(task))(chunk);
+          },
+      .task = &task,
+      .count = count,
+  };
+  detail::worker_pool::instance().execute(job);
+  for (auto& error : errors)
+    if (error) std::rethrow_exception(error);
+}
+
+/// Return the number of chunks `parallel_chunks` should use for `size`
+/// items such that no chunk is smaller than `grain` items.
+///
+inline auto chunk_count(size_t size, size_t grain = 1 << 14) noexcept
+    -> size_t {
+  return std::clamp<size_t>(size / std::max<size_t>(grain, 1), 1,
+                            thread_count());
+}
+
+/// Invoke `f(first, last)` in parallel on consecutive chunks of `[0, size)`.
+/// Small ranges, determined by `grain`, are processed on the calling thread.
+///
+void parallel_for_chunks(size_t size, auto&& f, size_t grain = 1 << 14) {
+  parallel_chunks(size, chunk_count(size, grain),
+                  [&f](size_t, size_t first, size_t last) {
+                    std::invoke(f, first, last);
+                  });
+}
+
+/// Invoke `f(i)` for every index `i` in `[0, size)` in parallel.
+///
+void parallel_for(size_t size, auto&& f, size_t grain = 1 << 14) {
+  parallel_for_chunks(
+      size,
+      [&f](size_t first, size_t last) {
+        for (auto i = first; i < last; ++i) std::invoke(f, i);
+      },
+      grain);
+}
+
+/// Invoke `f(i)` for every index `i` in `[0, size)` in parallel
+/// by letting all threads fetch the next index from a shared counter.
+/// Use this instead of `parallel_for` for few but unevenly sized tasks.
+///
+void parallel_for_dynamic(size_t size, auto&& f) {
+  std::atomic<size_t> next{0};
+  parallel_chunks(size, std::min(size, thread_count()),
+                  [&](size_t, size_t, size_t) {
+                    for (auto i = next++; i < size; i = next++)
+                      std::invoke(f, i);
+                  });
+}
+
+/// Replace every element of `data` by the sum of all its predecessors and
+/// return the total sum. The scan is carried out in two parallel passes over
+/// the same consecutive chunks. So, it is deterministic for all types.
+///
+template <typename type>
+auto parallel_exclusive_scan(std::span<type> data, type init = {}) -> type {
+  const auto count = chunk_count(data.size(), size_t{1} << 16);
+  std::vector<type> sums(count + 1, type{});
+  parallel_chunks(data.size(), count,
+                  [&](size_t chunk, size_t first, size_t last) {
+                    type sum{};
+                    for (auto i = first; i < last; ++i) sum += data[i];
+                    sums[chunk + 1] = sum;
+                  });
+  sums[0] = init;
+  for (size_t i = 0; i < count; ++i) sums[i + 1] += sums[i];
+  parallel_chunks(data.size(), count,
+                  [&](size_t chunk, size_t first, size_t last) {
+                    auto sum = sums[chunk];
+                    for (auto i = first; i < last; ++i)
+                      sum += std::exchange(data[i], sum);
+                  });
+  return sums[count];
+}
+
+/// Stable least-significant-digit radix sort of `keys` with 8-bit digits.
+/// Every permutation applied to `keys` is also applied to `values`.
+/// Only the lowest `bits` bits of every key are taken into account.
+/// Every pass computes per-chunk digit histograms and scatters the
+/// chunks in parallel. Passes in which all keys share the same digit are
+/// skipped. Hence, keys with many constant bits are sorted in fewer passes.
+///
+template <std::unsigned_integral key_type, typename value_type>
+void parallel_radix_sort(std::vector<key_type>& keys,
+                         std::vector<value_type>& values,
+                         size_t bits = 8 * sizeof(key_type)) {
+  assert(keys.size() == values.size());
+  constexpr size_t radix = 256;
+  const auto size = keys.size();
+  const auto count = chunk_count(size, size_t{1} << 16);
+
+  std::vector<key_type> key_buffer(size);
+  std::vector<value_type> value_buffer(size);
+  std::vector<std::array<size_t, radix>> offsets(count);
+
+  for (size_t shift = 0; shift < bits; shift += 8) {
+    const auto digit = [shift](key_type key) {
+      return static_cast<size_t>((key >> shift) & (radix - 1));
+    };
+
+    parallel_chunks(size, count, [&](size_t chunk, size_t first, size_t last) {
+      auto& histogram = offsets[chunk];
+      histogram.fill(0);
+      for (auto i = first; i < last; ++i) ++histogram[digit(keys[i])];
+    });
+
+    // Compute the scatter offsets in digit-major and chunk-minor order.
+    // This keeps the sort stable.
+    size_t offset = 0;
+    bool trivial = false;
+    for (size_t d = 0; d < radix; ++d) {
+      size_t total = 0;
+      for (size_t chunk = 0; chunk < count; ++chunk) {
+        total += offsets[chunk][d];
+        offsets[chunk][d] = offset + total - offsets[chunk][d];
+      }
+      if (total == size) trivial = true;
+      offset += total;
+    }
+    if (trivial) continue;
+
+    parallel_chunks(size, count, [&](size_t chunk, size_t first, size_t last) {
+      auto& offset = offsets[chunk];
+      for (auto i = first; i < last; ++i) {
+        const auto j = offset[digit(keys[i])]++;
+        key_buffer[j] = keys[i];
+        value_buffer[j] = std::move(values[i]);
+      }
+    });
+    std::swap(keys, key_buffer);
+    std::swap(values, value_buffer);
+  }
+}
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,135 @@
+#include <ensketch/sandbox/pick_buffer.hpp>
+
+namespace ensketch::sandbox {
+
+pick_buffer::pick_buffer() {
+  target.attach(GL_COLOR_ATTACHMENT0, ids);
+  target.attach(GL_DEPTH_ATTACHMENT, depth);
+  glNamedFramebufferReadBuffer(target.id(), GL_COLOR_ATTACHMENT0);
+  // The buffer is only read by the host.
+  glNamedBufferData(pixels.id(), max_pending * sizeof(uvec4), nullptr,
+                    GL_STREAM_READ);
+}
+
+pick_buffer::~pick_buffer() noexcept {
+  clear();
+}
+
+void pick_buffer::swap(pick_buffer& x) noexcept {
+  using std::swap;
+  swap(width, x.width);
+  swap(height, x.height);
+  swap(target, x.target);
+  swap(ids, x.ids);
+  swap(depth, x.depth);
+  swap(pixels, x.pixels);
+  swap(next_slot, x.next_slot);
+  swap(requests, x.requests);
+  swap(pending, x.pending);
+}
+
+void pick_buffer::resize(int w, int h) {
+  width = w;
+  height = h;
+  ids.allocate(GL_RGBA32UI, width, height);
+  depth.allocate(GL_DEPTH_COMPONENT24, width, height);
+  if (!target.complete())
+    throw runtime_error(
+        format("Failed to create framebuffer of size {}x{} for picking.",
+               width, height));
+}
+
+void pick_buffer::request(float x, float y, callback f) {
+  const ivec2 pixel{int(std::floor(x)), int(std::floor(y))};
+  requests.push_back({pixel, std::move(f)});
+}
+
+void pick_buffer::begin() const noexcept {
+  target.bind();
+  // Zero is used as face ID for the background.
+  const GLuint background[4]{};
+  const GLfloat far = 1.0f;
+  glClearNamedFramebufferuiv(target.id(), GL_COLOR, 0, background);
+  glClearNamedFramebufferfv(target.id(), GL_DEPTH, 0, &far);
+}
+
+void pick_buffer::end() {
+  target.bind();
+  pixels.bind();
+  // Callbacks of finished readbacks may already request new picks
+  // which are then served by the next rendering.
+  //
+  auto queue = std::move(requests);
+  requests.clear();
+  for (auto& [p, f] : queue) {
+    // Pixels outside of the window show nothing. They need no
+    // readback but are still answered in the order of requests.
+    //
+    if ((p.x < 0) || (p.y < 0) || (p.x >= width) || (p.y >= height)) {
+      pending.push_back({nullptr, 0, std::move(f)});
+      continue;
+    }
+
+    // Wait for the oldest readback if all slots are in use.
+    //
+    while (pending.size() >= max_pending) {
+      auto x = std::move(pending.front());
+      pending.pop_front();
+      finish(x);
+    }
+
+    const auto slot = next_slot;
+    next_slot = (next_slot + 1) % max_pending;
+    // Rows of OpenGL start at the bottom of the window.
+    glReadPixels(p.x, height - 1 - p.y, 1, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT,
+                 reinterpret_cast<void*>(slot * sizeof(uvec4)));
+    pending.push_back(
+        {glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, {}), slot, std::move(f)});
+  }
+  pixels.unbind();
+  opengl::framebuffer::unbind();
+}
+
+void pick_buffer::poll() {
+  while (!pending.empty()) {
+    auto& r = pending.front();
+    if (r.fence && (glClientWaitSync(r.fence, {}, 0) == GL_TIMEOUT_EXPIRED))
+      break;
+    // Callbacks may request new picks. So, the readback
+    // is removed from the queue before it is finished.
+    auto x = std::move(r);
+    pending.pop_front();
+    finish(x);
+  }
+}
+
+void pick_buffer::clear() noexcept {
+  for (auto& r : pending)
+    if (r.fence) glDeleteSync(r.fence);
+  pending.clear();
+  requests.clear();
+}
+
+void pick_buffer::finish(readback& r) {
+  hit result{};
+  if (r.fence) {
+    while (glClientWaitSync(r.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                            GLuint64(-1)) == GL_TIMEOUT_EXPIRED)
+      continue;
+    glDeleteSync(r.fence);
+    r.fence = nullptr;
+
+    uvec4 data;
+    glGetNamedBufferSubData(pixels.id(), r.slot * sizeof(uvec4), sizeof(uvec4),
+                            &data);
+    if (data.x != 0) {
+      result.f = data.x - 1;
+      result.u = std::bit_cast<float32>(data.y);
+      result.v = std::bit_cast<float32>(data.z);
+      result.t = std::bit_cast<float32>(data.w);
+    }
+  }
+  r.f(result);
+}
+
+}  // namespace ensketch::sandbox
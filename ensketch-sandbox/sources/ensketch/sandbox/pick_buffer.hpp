@@ -0,0 +1,112 @@
+#pragma once
+#include <ensketch/sandbox/ray_tracer.hpp>
+#include <ensketch/sandbox/utility.hpp>
+//
+#include <ensketch/opengl/opengl.hpp>
+
+namespace ensketch::sandbox {
+
+/// Offscreen integer render target that stores for every pixel the
+/// visible face of the surface, the barycentric coordinates of the visible
+/// point and its distance to the camera. Reading a single pixel answers a
+/// pick with constant cost that does not depend on the size of the surface.
+/// The pixels are copied into a pixel pack buffer guarded by a fence and
+/// handed out a few frames later. So, picking never stalls the pipeline.
+/// An OpenGL context must be current for the whole lifetime.
+///
+class pick_buffer {
+ public:
+  using hit = ray_polyhedral_surface_intersection;
+  using callback = std::function<void(const hit&)>;
+
+  /// Number of readbacks that may be in flight at the same time.
+  /// If all are in use, the oldest one is waited for.
+  ///
+  static constexpr size_t max_pending = 16;
+
+  pick_buffer();
+  ~pick_buffer() noexcept;
+
+  // The fences of pending readbacks are owned.
+  // So, copying is NOT allowed whereas moving is.
+  //
+  pick_buffer(const pick_buffer&) = delete;
+  pick_buffer& operator=(const pick_buffer&) = delete;
+  // Members are moved one by one. The moved-from buffer
+  // owns no GL objects and no pending readbacks afterwards.
+  //
+  pick_buffer(pick_buffer&& x) noexcept
+      : width{std::exchange(x.width, 0)},
+        height{std::exchange(x.height, 0)},
+        target{std::move(x.target)},
+        ids{std::move(x.ids)},
+        depth{std::move(x.depth)},
+        pixels{std::move(x.pixels)},
+        next_slot{std::exchange(x.next_slot, 0)},
+        requests{std::exchange(x.requests, {})},
+        pending{std::exchange(x.pending, {})} {}
+  pick_buffer& operator=(pick_buffer&& x) noexcept {
+    swap(x);
+    return *this;
+  }
+
+  void swap(pick_buffer& x) noexcept;
+
+  void resize(int width, int height);
+
+  /// Request the pick of the pixel at the given window coordinates
+  /// whose origin is the top left corner. The callback receives the result
+  /// after the pixel has been rendered with the next call to `begin` and
+  /// `end` and its readback has finished. The face is invalid for pixels
+  /// that show no surface or lie outside the window.
+  ///
+  void request(float x, float y, callback f);
+
+  /// Check whether there are requests that wait for the next rendering.
+  ///
+  bool has_requests() const noexcept { return !requests.empty(); }
+
+  /// Bind and clear the render target. Afterwards, the faces of the surface
+  /// have to be drawn with a shader that writes the face ID plus one, the
+  /// bits of the two barycentric coordinates, and the bits of the distance
+  /// to the camera to an unsigned integer output at location zero.
+  ///
+  void begin() const noexcept;
+
+  /// Start the readbacks of all requested pixels
+  /// and bind the default framebuffer again.
+  ///
+  void end();
+
+  /// Call the callbacks of all finished readbacks in request order.
+  /// This never blocks.
+  ///
+  void poll();
+
+  /// Drop all requests and readbacks without calling their callbacks,
+  /// for example, when the surface has changed.
+  ///
+  void clear() noexcept;
+
+ private:
+  struct readback {
+    GLsync fence;
+    size_t slot;
+    callback f;
+  };
+
+  void finish(readback& r);
+
+  int width{};
+  int height{};
+  opengl::framebuffer target{};
+  opengl::renderbuffer ids{};
+  opengl::renderbuffer depth{};
+  // One slot of four unsigned integers per readback.
+  opengl::pixel_pack_buffer pixels{};
+  size_t next_slot = 0;
+  vector<pair<ivec2, callback>> requests{};
+  std::deque<readback> pending{};
+};
+
+}  // namespace ensketch::sandbox
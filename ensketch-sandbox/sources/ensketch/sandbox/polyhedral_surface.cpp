@@ -1,8 +1,7 @@
 #include <ensketch/sandbox/polyhedral_surface.hpp>
 //
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-#include <assimp/Importer.hpp>
+#include <ensketch/sandbox/log.hpp>
+#include <ensketch/sandbox/polyhedral_surface_cache.hpp>
 
 namespace ensketch::sandbox {
 
@@ -14,123 +13,171 @@ auto polyhedral_surface_from(const stl_surface& data) -> polyhedral_surface {
   surface.vertices.resize(data.triangles.size() * 3);
   surface.faces.resize(data.triangles.size());
 
-  for (size_type i = 0; i < data.triangles.size(); ++i) {
+  parallel_for(data.triangles.size(), [&](size_type i) {
     for (size_type j = 0; j < 3; ++j)
       surface.vertices[3 * i + j] = {
           .position = data.triangles[i].vertex[j],
           .normal = data.triangles[i].normal,
       };
     surface.faces[i] = {3 * i + 0, 3 * i + 1, 3 * i + 2};
-  }
+  });
 
   return surface;
 }
 
-auto polyhedral_surface_from(const filesystem::path& path)
-    -> polyhedral_surface {
-  // Generate functor for prefixed error messages.
-  //
-  const auto throw_error = [&](czstring str) {
-    throw runtime_error("Failed to load 'polyhedral_surface' from path '"s +
-                        path.string() + "'. " + str);
-  };
+auto vertex_welding_from(const stl_surface& data, float32 epsilon)
+    -> vertex_welding {
+  return vertex_welding_from(
+      3 * data.triangles.size(),
+      [&](size_t i) { return data.triangles[i / 3].vertex[i % 3]; }, epsilon);
+}
 
-  if (!exists(path)) throw_error("The path does not exist.");
+auto polyhedral_surface_from(const stl_surface& data,
+                             const vertex_welding& welding)
+    -> polyhedral_surface {
+  using size_type = polyhedral_surface::size_type;
+  assert(welding.remap.size() == 3 * data.triangles.size());
 
-  // Use a custom loader for STL files.
-  //
-  if (path.extension().string() == ".stl" ||
-      path.extension().string() == ".STL")
-    return polyhedral_surface_from(stl_surface(path));
+  const auto corner = [&](size_type p) {
+    return data.triangles[p / 3].vertex[p % 3];
+  };
 
-  // For all other file formats, assimp will do the trick.
-  //
-  Assimp::Importer importer{};
+  polyhedral_surface surface{};
 
-  // Assimp only needs to generate a continuously connected surface.
-  // So, a lot of information can be stripped from vertices.
+  // Every vertex only accumulates the normals of its own points.
+  // So, no synchronization is needed and the results are deterministic.
   //
-  importer.SetPropertyInteger(
-      AI_CONFIG_PP_RVC_FLAGS,
-      /*aiComponent_NORMALS |*/ aiComponent_TANGENTS_AND_BITANGENTS |
-          aiComponent_COLORS |
-          /*aiComponent_TEXCOORDS |*/ aiComponent_BONEWEIGHTS |
-          aiComponent_ANIMATIONS | aiComponent_TEXTURES | aiComponent_LIGHTS |
-          aiComponent_CAMERAS /*| aiComponent_MESHES*/ | aiComponent_MATERIALS);
-
-  // After the stripping and loading,
-  // certain post processing steps are mandatory.
-  //
-  const auto post_processing =
-      aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals |
-      aiProcess_JoinIdenticalVertices | aiProcess_RemoveComponent |
-      /*aiProcess_OptimizeMeshes |*/ /*aiProcess_OptimizeGraph |*/
-      aiProcess_FindDegenerates /*| aiProcess_DropNormals*/;
-
-  // Now, let Assimp actually load a surface scene from the given file.
+  surface.vertices.resize(welding.vertex_count());
+  parallel_for(surface.vertices.size(), [&](size_type v) {
+    const auto first = welding.offsets[v];
+    const auto last = welding.offsets[v + 1];
+    vec3 normal{};
+    for (auto k = first; k < last; ++k) {
+      const auto& t = data.triangles[welding.points[k] / 3];
+      normal += cross(t.vertex[1] - t.vertex[0], t.vertex[2] - t.vertex[0]);
+    }
+    const auto p = welding.points[first];
+    const auto l = length(normal);
+    surface.vertices[v] = {
+        .position = corner(p),
+        .normal = (l > 0) ? normal / l : data.triangles[p / 3].normal,
+    };
+  });
+
+  // Remove degenerate faces by a parallel stream compaction.
   //
-  const auto scene = importer.ReadFile(path.c_str(), post_processing);
+  const auto face_of = [&](size_type i) {
+    return polyhedral_surface::face{welding.remap[3 * i + 0],
+                                    welding.remap[3 * i + 1],
+                                    welding.remap[3 * i + 2]};
+  };
+  const auto degenerate = [](const polyhedral_surface::face& f) {
+    return (f[0] == f[1]) || (f[1] == f[2]) || (f[2] == f[0]);
+  };
+  vector<size_type> offsets(data.triangles.size());
+  parallel_for(offsets.size(),
+               [&](size_type i) { offsets[i] = !degenerate(face_of(i)); });
+  surface.faces.resize(parallel_exclusive_scan(std::span{offsets}));
+  parallel_for(offsets.size(), [&](size_type i) {
+    const auto f = face_of(i);
+    if (!degenerate(f)) surface.faces[offsets[i]] = f;
+  });
 
-  // Check whether Assimp could load the file at all.
-  //
-  if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
-    throw_error("Assimp could not process the file.");
+  return surface;
+}
 
-  // Now, transform the loaded mesh data from
-  // Assimp's internal structure to a polyhedral surface.
-  //
+auto polyhedral_surface_from(const scene& in) -> polyhedral_surface {
   polyhedral_surface surface{};
 
-  // First, get the total number of vertices
-  // and faces and for all meshes.
+  // All meshes will be linearly stored in one polyhedral surface.
   //
   size_t vertex_count = 0;
   size_t face_count = 0;
-  for (size_t i = 0; i < scene->mNumMeshes; ++i) {
-    vertex_count += scene->mMeshes[i]->mNumVertices;
-    face_count += scene->mMeshes[i]->mNumFaces;
+  for (const auto& mesh : in.meshes) {
+    vertex_count += mesh.vertices.size();
+    face_count += mesh.faces.size();
   }
-  //
   surface.vertices.resize(vertex_count);
   surface.faces.resize(face_count);
 
-  // Iterate over all meshes and get the vertex and face information.
-  // All meshes will be linearly stored in one polyhedral surface.
-  //
   uint32 vertex_offset = 0;
   uint32 face_offset = 0;
-  for (size_t mid = 0; mid < scene->mNumMeshes; ++mid) {
-    // Vertices of the Mesh
-    //
-    for (size_t vid = 0; vid < scene->mMeshes[mid]->mNumVertices; ++vid) {
-      surface.vertices[vid + vertex_offset] = {
-          .position = {scene->mMeshes[mid]->mVertices[vid].x,  //
-                       scene->mMeshes[mid]->mVertices[vid].y,  //
-                       scene->mMeshes[mid]->mVertices[vid].z},
-          .normal = {scene->mMeshes[mid]->mNormals[vid].x,  //
-                     scene->mMeshes[mid]->mNormals[vid].y,  //
-                     scene->mMeshes[mid]->mNormals[vid].z}};
+  for (const auto& mesh : in.meshes) {
+    for (size_t vid = 0; vid < mesh.vertices.size(); ++vid)
+      surface.vertices[vertex_offset + vid] = {
+          .position = mesh.vertices[vid].position,
+          .normal = mesh.vertices[vid].normal};
+    for (size_t fid = 0; fid < mesh.faces.size(); ++fid) {
+      const auto& f = mesh.faces[fid];
+      surface.faces[face_offset + fid] = {
+          f[0] + vertex_offset, f[1] + vertex_offset, f[2] + vertex_offset};
     }
 
-    // Faces of the Mesh
+    // Update offsets to not overwrite previously written meshes.
     //
-    for (size_t fid = 0; fid < scene->mMeshes[mid]->mNumFaces; ++fid) {
-      // All faces need to be triangles.
-      // So, use a simple triangulation of polygons.
-      const auto corners = scene->mMeshes[mid]->mFaces[fid].mNumIndices;
-      for (size_t k = 2; k < corners; ++k) {
-        surface.faces[face_offset + fid] = {
-            scene->mMeshes[mid]->mFaces[fid].mIndices[0] + vertex_offset,  //
-            scene->mMeshes[mid]->mFaces[fid].mIndices[k - 1] +
-                vertex_offset,  //
-            scene->mMeshes[mid]->mFaces[fid].mIndices[k] + vertex_offset};
-      }
-    }
+    vertex_offset += mesh.vertices.size();
+    face_offset += mesh.faces.size();
+  }
 
-    // Update offsets to not overwrite previously written meshes.
+  return surface;
+}
+
+namespace {
+
+// Load the surface from the source file without any caching.
+//
+auto polyhedral_surface_from_file(const filesystem::path& path)
+    -> polyhedral_surface {
+  // Use a custom loader for STL files.
+  //
+  if (path.extension().string() == ".stl" ||
+      path.extension().string() == ".STL") {
+    // STL files store every triangle separately.
+    // To get a connected surface, coinciding corners need to be welded.
     //
-    vertex_offset += scene->mMeshes[mid]->mNumVertices;
-    face_offset += scene->mMeshes[mid]->mNumFaces;
+    const stl_surface data{path};
+    return polyhedral_surface_from(data, vertex_welding_from(data));
+  }
+
+  // For all other file formats, the scene import will do the trick.
+  //
+  return polyhedral_surface_from(scene_from_file(path));
+}
+
+}  // namespace
+
+auto polyhedral_surface_from(const filesystem::path& path)
+    -> polyhedral_surface {
+  if (!exists(path))
+    throw runtime_error("Failed to load 'polyhedral_surface' from path '"s +
+                        path.string() + "'. The path does not exist.");
+
+  // Try to reuse the cache of a previous load.
+  // Missing, outdated, or broken caches are simply regenerated.
+  //
+  const auto stamp = polyhedral_surface_cache::stamp_of(path);
+  filesystem::path cache_path{};
+  try {
+    cache_path = polyhedral_surface_cache::path_for(path);
+    if (exists(cache_path)) {
+      const polyhedral_surface_cache cache{cache_path};
+      if (cache.source() == stamp) return polyhedral_surface_from(cache);
+    }
+  } catch (runtime_error& e) {
+    log::warn(e.what());
+  }
+
+  auto surface = polyhedral_surface_from_file(path);
+  surface.generate_edges();
+
+  // Failing to write the cache only affects later loads.
+  //
+  if (!cache_path.empty()) {
+    try {
+      polyhedral_surface_cache::write(cache_path, surface, stamp);
+    } catch (runtime_error& e) {
+      log::warn(e.what());
+    }
   }
 
   return surface;
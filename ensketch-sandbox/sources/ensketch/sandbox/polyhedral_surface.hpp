@@ -1,8 +1,12 @@
 #pragma once
 #include <ensketch/opengl/opengl.hpp>
 #include <ensketch/sandbox/aabb.hpp>
+#include <ensketch/sandbox/halfedge_connectivity.hpp>
+#include <ensketch/sandbox/scene.hpp>
 #include <ensketch/sandbox/stl_surface.hpp>
 #include <ensketch/sandbox/utility.hpp>
+#include <ensketch/sandbox/vertex_one_rings.hpp>
+#include <ensketch/sandbox/vertex_welding.hpp>
 
 namespace ensketch::sandbox {
 
@@ -21,56 +25,108 @@ struct polyhedral_surface {
   struct face : array<vertex_id, 3> {};
   using face_id = uint32;
 
-  struct edge : array<vertex_id, 2> {
-    struct info {
-      face_id face;
-    };
+  using halfedge_id = halfedge_connectivity::halfedge_id;
 
-    struct hasher {
-      auto operator()(const edge& e) const noexcept -> size_t {
-        return (size_t(e[0]) << 7) ^ size_t(e[1]);
+  // Generate the connectivity, the one-rings, and the per-vertex edge
+  // statistics. This needs to be called after every change of `faces`.
+  //
+  // The statistics are gathered in parallel by a single pass over the
+  // one-rings. So, every thread only writes to its own range of vertices
+  // and all sums are evaluated in a fixed order. Hence, the results are
+  // deterministic.
+  //
+  void generate_edges() {
+    connectivity = halfedge_connectivity_from(faces, vertices.size());
+    one_rings = vertex_one_rings_from(faces, connectivity);
+
+    neighbor_count.resize(vertices.size());
+    mean_edge_length.resize(vertices.size());
+    max_edge_length.resize(vertices.size());
+
+    parallel_for(vertices.size(), [&](vertex_id vid) {
+      const auto& position = vertices[vid].position;
+      const auto ring = one_rings.vertices_of(vid);
+      float sum = 0;
+      float max = 0;
+      for (auto x : ring) {
+        const auto l = distance(position, vertices[x].position);
+        sum += l;
+        max = std::max(max, l);
       }
-    };
-  };
+      neighbor_count[vid] = ring.size();
+      mean_edge_length[vid] = ring.empty() ? 0 : sum / ring.size();
+      max_edge_length[vid] = max;
+    });
+  }
 
-  void generate_edges() {
-    edges.clear();
-    for (size_t i = 0; i < faces.size(); ++i) {
-      const auto& f = faces[i];
-      edges[edge{f[0], f[1]}].face = i;
-      edges[edge{f[1], f[2]}].face = i;
-      edges[edge{f[2], f[0]}].face = i;
-    }
-
-    neighbor_count.assign(vertices.size(), 0);
-    mean_edge_length.assign(vertices.size(), 0);
-    max_edge_length.assign(vertices.size(), 0);
-
-    for (const auto& [e, _] : edges) {
-      const auto vid = e[0];
-      const auto nid = e[1];
-      ++neighbor_count[vid];
-      const auto l = distance(vertices[vid].position, vertices[nid].position);
-      mean_edge_length[vid] += l;
-
-      max_edge_length[vid] = std::max(max_edge_length[vid], l);
-      max_edge_length[nid] = std::max(max_edge_length[nid], l);
-    }
-    for (size_t i = 0; i < vertices.size(); ++i)
-      mean_edge_length[i] /= neighbor_count[i];
+  // Check whether there is a face with the oriented edge from `p` to `q`.
+  //
+  bool has_edge(vertex_id p, vertex_id q) const noexcept {
+    return connectivity.contains(p, q);
+  }
+
+  // Check whether `p` and `q` are connected by an edge in any orientation.
+  //
+  bool adjacent(vertex_id p, vertex_id q) const noexcept {
+    return one_rings.contains(p, q);
+  }
+
+  // Return the face containing the oriented edge from `p` to `q`.
+  // If there is no such face, `invalid` is returned.
+  //
+  auto face_of(vertex_id p, vertex_id q) const noexcept -> face_id {
+    const auto h = connectivity.halfedge(p, q);
+    return (h == invalid) ? invalid : halfedge_connectivity::face(h);
   }
 
   vector<vertex> vertices{};
   vector<face> faces{};
-  unordered_map<edge, edge::info, edge::hasher> edges{};
+  halfedge_connectivity connectivity{};
+  vertex_one_rings one_rings{};
 
   vector<size_t> neighbor_count{};
   vector<float> mean_edge_length{};
   vector<float> max_edge_length{};
+
+  // Baked ambient occlusion per vertex. It is empty if it has not been
+  // baked yet and is cached together with the surface.
+  // See `ambient_occlusion_bake`.
+  //
+  vector<float32> ambient_occlusion{};
 };
 
+// Every triangle of the STL data gets its own three vertices.
+// So, no edges are shared and the surface is not connected.
+//
 auto polyhedral_surface_from(const stl_surface& data) -> polyhedral_surface;
 
+/// Weld the triangle corners of the given STL data.
+/// The point with index `3 * i + j` refers to corner `j` of triangle `i`.
+/// See `vertex_welding_key_from` for the meaning of `epsilon`.
+///
+auto vertex_welding_from(const stl_surface& data, float32 epsilon = 0)
+    -> vertex_welding;
+
+/// Construct an indexed and connected surface from STL data by using
+/// the given welding of its triangle corners. Vertex normals are computed
+/// as area-weighted sums of the adjacent face normals. Triangles that
+/// degenerate due to welding are removed.
+///
+auto polyhedral_surface_from(const stl_surface& data,
+                             const vertex_welding& welding)
+    -> polyhedral_surface;
+
+/// Store all meshes of an imported scene in one polyhedral surface.
+/// Edges are not generated.
+///
+auto polyhedral_surface_from(const scene& in) -> polyhedral_surface;
+
+/// Load a polyhedral surface with generated edges from the given file.
+/// STL files are welded and all other formats are imported as scene.
+/// The first load of a file writes a binary cache that is reused
+/// by later loads as long as the file's size and modification time
+/// do not change. See `polyhedral_surface_cache`.
+///
 auto polyhedral_surface_from(const filesystem::path& path)
     -> polyhedral_surface;
 
@@ -79,119 +135,4 @@ auto polyhedral_surface_from(const filesystem::path& path)
 ///
 auto aabb_from(const polyhedral_surface& surface) noexcept -> aabb3;
 
-inline auto bipartition_from(const polyhedral_surface& surface,
-                             const vector<polyhedral_surface::vertex_id>& curve,
-                             bool closed = true) -> vector<float> {
-  const auto throw_error = [] {
-    throw runtime_error(
-        "Failed to generate surface bi-partition from given surface vertex "
-        "curve.");
-  };
-
-  if (curve.empty()) throw_error();
-
-  // constexpr uint8 r_flag = 0b01;
-  // constexpr uint8 l_flag = 0b10;
-  // constexpr uint8 both = 0b11;
-
-  vector<float> face_mask{};
-  face_mask.assign(surface.faces.size(), 0.0f);
-
-  vector<polyhedral_surface::face_id> face_stack{};
-
-  for (size_t i = 1; i < curve.size(); ++i) {
-    const auto p = curve[i - 1];
-    const auto q = curve[i];
-
-    const auto fr = surface.edges.at(polyhedral_surface::edge{p, q}).face;
-    face_mask[fr] = 1.0f;
-    // face_mask[fr] |= r_flag;
-
-    const auto fl = surface.edges.at(polyhedral_surface::edge{q, p}).face;
-    face_mask[fl] = -1.0f;
-    // face_mask[fl] |= l_flag;
-
-    // if (face_mask[fr] == both) throw_error();
-    // if (face_mask[fl] == both) throw_error();
-
-    // face_stack.push_back(fr);
-    // face_stack.push_back(fl);
-  }
-  if (closed) {
-    const auto p = curve.back();
-    const auto q = curve.front();
-
-    const auto fr = surface.edges.at(polyhedral_surface::edge{p, q}).face;
-    face_mask[fr] = 1.0f;
-    // face_mask[fr] |= r_flag;
-
-    const auto fl = surface.edges.at(polyhedral_surface::edge{q, p}).face;
-    face_mask[fl] = -1.0f;
-    // face_mask[fl] |= l_flag;
-
-    // if (face_mask[fr] == both) throw_error();
-    // if (face_mask[fl] == both) throw_error();
-
-    // face_stack.push_back(fr);
-    // face_stack.push_back(fl);
-  }
-
-  for (size_t i = 0; i < surface.faces.size(); ++i) {
-    if (face_mask[i]) continue;
-    const auto face = surface.faces[i];
-    const auto n0 =
-        surface.edges.at(polyhedral_surface::edge{face[1], face[0]}).face;
-    const auto n1 =
-        surface.edges.at(polyhedral_surface::edge{face[2], face[1]}).face;
-    const auto n2 =
-        surface.edges.at(polyhedral_surface::edge{face[0], face[2]}).face;
-    if ((face_mask[n0] != 0.0f) || (face_mask[n1] != 0.0f) ||
-        (face_mask[n2] != 0.0f))
-      face_stack.push_back(i);
-  }
-
-  while (!face_stack.empty()) {
-    const auto f = face_stack.back();
-    face_stack.pop_back();
-
-    const auto face = surface.faces[f];
-    const auto n0 =
-        surface.edges.at(polyhedral_surface::edge{face[1], face[0]}).face;
-    const auto n1 =
-        surface.edges.at(polyhedral_surface::edge{face[2], face[1]}).face;
-    const auto n2 =
-        surface.edges.at(polyhedral_surface::edge{face[0], face[2]}).face;
-
-    bool left = false;
-    bool right = false;
-
-    if (face_mask[n0] == 0.0f)
-      face_stack.push_back(n0);
-    else {
-      if (face_mask[n0] < 0.0f) left = true;
-      if (face_mask[n0] > 0.0f) right = true;
-    }
-
-    if (face_mask[n1] == 0.0f)
-      face_stack.push_back(n1);
-    else {
-      if (face_mask[n1] < 0.0f) left = true;
-      if (face_mask[n1] > 0.0f) right = true;
-    }
-
-    if (face_mask[n2] == 0.0f)
-      face_stack.push_back(n2);
-    else {
-      if (face_mask[n2] < 0.0f) left = true;
-      if (face_mask[n2] > 0.0f) right = true;
-    }
-
-    if (left && right) throw_error();
-    if (left) face_mask[f] = -1.0f;
-    if (right) face_mask[f] = 1.0f;
-  }
-
-  return face_mask;
-}
-
 }  // namespace ensketch::sandbox
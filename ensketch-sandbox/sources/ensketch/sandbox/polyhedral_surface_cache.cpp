@@ -0,0 +1,292 @@
+#include <ensketch/sandbox/polyhedral_surface_cache.hpp>
+//
+#include <ensketch/sandbox/cache.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+constexpr array<char, 8> magic{'E', 'N', 'S', 'K', 'S', 'U', 'R', 'F'};
+
+// Sections are aligned to cache lines. This also satisfies
+// the alignment requirements of all stored types.
+//
+constexpr size_t alignment = 64;
+
+struct file_header {
+  array<char, 8> magic;
+  uint32 version;
+  uint32 section_count;
+  int64 time;
+  uint64 size;
+};
+
+struct section_entry {
+  uint32 id;
+  uint32 element_size;
+  uint64 offset;
+  uint64 count;
+};
+
+using section = polyhedral_surface_cache::section;
+constexpr auto section_count = static_cast<size_t>(section::count);
+
+// Element size of every section in the order of `section`.
+//
+constexpr array<uint32, section_count> element_sizes{
+    sizeof(polyhedral_surface::vertex),
+    sizeof(polyhedral_surface::face),
+    sizeof(uint32),
+    sizeof(uint32),
+    sizeof(uint32),
+    sizeof(uint32),
+    sizeof(uint32),
+    sizeof(uint32),
+    sizeof(uint32),
+    sizeof(uint64),
+    sizeof(float32),
+    sizeof(float32),
+    sizeof(float32)};
+
+static_assert(std::is_trivially_copyable_v<polyhedral_surface::vertex>);
+static_assert(std::is_trivially_copyable_v<polyhedral_surface::face>);
+static_assert(sizeof(size_t) == sizeof(uint64));
+
+// Copy a section into a vector by parallel `memcpy` of large chunks.
+//
+template <typename type>
+void assign(vector<type>& data, std::span<const type> source) {
+  data.resize(source.size());
+  parallel_for_chunks(
+      source.size(),
+      [&](size_t first, size_t last) {
+        std::memcpy(data.data() + first, source.data() + first,
+                    (last - first) * sizeof(type));
+      },
+      size_t{1} << 18);
+}
+
+// Check in parallel whether `f(i)` holds for every index `i` in `[0, size)`.
+// Every chunk stops at its first failure and reports it separately.
+//
+bool parallel_all_of(size_t size, auto&& f) {
+  const auto count = chunk_count(size);
+  vector<char> valid(count, true);
+  parallel_chunks(size, count, [&](size_t chunk, size_t first, size_t last) {
+    for (auto i = first; i < last; ++i) {
+      if (std::invoke(f, i)) continue;
+      valid[chunk] = false;
+      return;
+    }
+  });
+  return std::ranges::all_of(valid, [](char x) { return bool(x); });
+}
+
+// Check that `offsets` is a valid CSR offset array of a row structure
+// with `size` entries in total.
+//
+bool valid_offsets(std::span<const uint32> offsets, size_t size) {
+  if (offsets.empty() || (offsets.front() != 0) || (offsets.back() != size))
+    return false;
+  return parallel_all_of(offsets.size() - 1, [&](size_t i) {
+    return offsets[i] <= offsets[i + 1];
+  });
+}
+
+// Check that all values of an index section are smaller than `bound`.
+// Boundary halfedges store `invalid` as twin and may be explicitly allowed.
+//
+bool valid_indices(std::span<const uint32> ids, size_t bound,
+                   bool allow_invalid = false) {
+  return parallel_all_of(ids.size(), [&](size_t i) {
+    return (ids[i] < bound) ||
+           (allow_invalid && (ids[i] == polyhedral_surface::invalid));
+  });
+}
+
+}  // namespace
+
+auto polyhedral_surface_cache::stamp_of(const filesystem::path& path)
+    -> stamp {
+  return {
+      .time = static_cast<int64>(
+          filesystem::last_write_time(path).time_since_epoch().count()),
+      .size = static_cast<uint64>(filesystem::file_size(path)),
+  };
+}
+
+auto polyhedral_surface_cache::path_for(const filesystem::path& source)
+    -> filesystem::path {
+  const auto key = filesystem::absolute(source).lexically_normal().string();
+  return cache_directory() / std::format("{}-{:016x}.surface",
+                                         source.stem().string(),
+                                         fnv1a_hash(key));
+}
+
+void polyhedral_surface_cache::write(const filesystem::path& path,
+                                     const polyhedral_surface& surface,
+                                     const stamp& source) {
+  const auto& c = surface.connectivity;
+  const auto& r = surface.one_rings;
+  const auto bytes = [](const auto& data) {
+    return std::string_view{reinterpret_cast<const char*>(data.data()),
+                            data.size() * sizeof(data[0])};
+  };
+  const array<std::string_view, section_count> data{
+      bytes(surface.vertices),         bytes(surface.faces),
+      bytes(c.offsets),                bytes(c.targets),
+      bytes(c.halfedges),              bytes(c.twins),
+      bytes(r.vertex_offsets),         bytes(r.adjacent_vertices),
+      bytes(r.adjacent_faces),
+      bytes(surface.neighbor_count),   bytes(surface.mean_edge_length),
+      bytes(surface.max_edge_length),  bytes(surface.ambient_occlusion)};
+
+  const auto align = [](size_t x) {
+    return (x + alignment - 1) / alignment * alignment;
+  };
+
+  const file_header header{
+      .magic = magic,
+      .version = version,
+      .section_count = section_count,
+      .time = source.time,
+      .size = source.size,
+  };
+  array<section_entry, section_count> table{};
+  auto offset = align(sizeof(file_header) + sizeof(table));
+  for (uint32 i = 0; i < section_count; ++i) {
+    table[i] = {
+        .id = i,
+        .element_size = element_sizes[i],
+        .offset = offset,
+        .count = data[i].size() / element_sizes[i],
+    };
+    offset = align(offset + data[i].size());
+  }
+
+  write_file_atomically(path, [&](std::ostream& file) {
+    const array<char, alignment> padding{};
+    size_t position = 0;
+    const auto put = [&](std::string_view x) {
+      file.write(x.data(), x.size());
+      position += x.size();
+    };
+    put({reinterpret_cast<const char*>(&header), sizeof(header)});
+    put({reinterpret_cast<const char*>(table.data()), sizeof(table)});
+    for (size_t i = 0; i < section_count; ++i) {
+      put({padding.data(), table[i].offset - position});
+      put(data[i]);
+    }
+  });
+}
+
+polyhedral_surface_cache::polyhedral_surface_cache(
+    const filesystem::path& path)
+    : file{path} {
+  // Generate functor for prefixed error messages.
+  //
+  const auto throw_error = [&](czstring str) {
+    throw std::runtime_error(std::format(
+        "Failed to open polyhedral surface cache '{}'. {}", path.string(),
+        str));
+  };
+
+  const auto size = file.size();
+  if (size < sizeof(file_header) + section_count * sizeof(section_entry))
+    throw_error("The file is too small.");
+
+  file_header header{};
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (header.magic != magic) throw_error("The file is no surface cache.");
+  if (header.version != version)
+    throw_error("The file has been written by a different version.");
+  if (header.section_count != section_count)
+    throw_error("The section table is invalid.");
+  _source = {.time = header.time, .size = header.size};
+
+  array<section_entry, section_count> table{};
+  std::memcpy(table.data(), file.data() + sizeof(header), sizeof(table));
+  for (const auto& entry : table) {
+    if ((entry.id >= section_count) ||
+        (entry.element_size != element_sizes[entry.id]) ||
+        (entry.offset % alignment != 0) || (entry.offset > size) ||
+        (entry.count > (size - entry.offset) / entry.element_size))
+      throw_error("The section table is invalid.");
+    sections[entry.id] = {file.data() + entry.offset, entry.count};
+  }
+
+  // Check the consistency of all section sizes.
+  // Baked attributes are optional and may be empty.
+  //
+  const auto vertex_count = vertices().size();
+  const auto halfedge_count = 3 * faces().size();
+  if ((offsets().size() != vertex_count + 1) ||
+      (targets().size() != halfedge_count) ||
+      (halfedges().size() != halfedge_count) ||
+      (twins().size() != halfedge_count) ||
+      (one_ring_offsets().size() != vertex_count + 1) ||
+      (one_ring_vertices().size() != one_ring_offsets().back()) ||
+      (one_ring_faces().size() != halfedge_count) ||
+      (neighbor_count().size() != vertex_count) ||
+      (mean_edge_length().size() != vertex_count) ||
+      (max_edge_length().size() != vertex_count) ||
+      (!ambient_occlusion().empty() &&
+       (ambient_occlusion().size() != vertex_count)))
+    throw_error("The section sizes are inconsistent.");
+
+  // A damaged file may still have consistent section sizes. All indices are
+  // checked here once such that the surface and the structures built from
+  // it never access out of bounds. Invalid caches are then regenerated.
+  //
+  const auto face_count = faces().size();
+  const auto f = faces();
+  if (!parallel_all_of(face_count,
+                       [&](size_t i) {
+                         return (f[i][0] < vertex_count) &&
+                                (f[i][1] < vertex_count) &&
+                                (f[i][2] < vertex_count);
+                       }) ||
+      !valid_offsets(offsets(), halfedge_count) ||
+      !valid_indices(targets(), vertex_count) ||
+      !valid_indices(halfedges(), halfedge_count) ||
+      !valid_indices(twins(), halfedge_count, true) ||
+      !valid_offsets(one_ring_offsets(), one_ring_vertices().size()) ||
+      !valid_indices(one_ring_vertices(), vertex_count) ||
+      !valid_indices(one_ring_faces(), face_count))
+    throw_error("The section data contains invalid indices.");
+}
+
+auto polyhedral_surface_from(const polyhedral_surface_cache& cache)
+    -> polyhedral_surface {
+  polyhedral_surface surface{};
+  assign(surface.vertices, cache.vertices());
+  assign(surface.faces, cache.faces());
+  assign(surface.connectivity.offsets, cache.offsets());
+  assign(surface.connectivity.targets, cache.targets());
+  assign(surface.connectivity.halfedges, cache.halfedges());
+  assign(surface.connectivity.twins, cache.twins());
+  // Face rows of the one-rings are the rows of outgoing halfedges.
+  surface.one_rings.face_offsets = surface.connectivity.offsets;
+  assign(surface.one_rings.vertex_offsets, cache.one_ring_offsets());
+  assign(surface.one_rings.adjacent_vertices, cache.one_ring_vertices());
+  assign(surface.one_rings.adjacent_faces, cache.one_ring_faces());
+  assign(surface.neighbor_count,
+         std::span{reinterpret_cast<const size_t*>(
+                       cache.neighbor_count().data()),
+                   cache.neighbor_count().size()});
+  assign(surface.mean_edge_length, cache.mean_edge_length());
+  assign(surface.max_edge_length, cache.max_edge_length());
+  assign(surface.ambient_occlusion, cache.ambient_occlusion());
+  return surface;
+}
+
+auto update_cache(const filesystem::path& source,
+                  const polyhedral_surface_cache::stamp& stamp,
+                  const polyhedral_surface& surface) -> bool {
+  if (polyhedral_surface_cache::stamp_of(source) != stamp) return false;
+  polyhedral_surface_cache::write(polyhedral_surface_cache::path_for(source),
+                                  surface, stamp);
+  return true;
+}
+
+}  // namespace ensketch::sandbox
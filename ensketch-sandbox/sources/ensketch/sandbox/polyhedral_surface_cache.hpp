@@ -0,0 +1,135 @@
+#pragma once
+#include <ensketch/sandbox/memory_mapped_file.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+
+namespace ensketch::sandbox {
+
+/// Read-only view of a binary cache file for a polyhedral surface
+/// with generated edges. The file consists of a header, a section table,
+/// and the raw arrays of all sections aligned to cache lines.
+/// The file is memory-mapped and all sections are directly accessible
+/// as spans without copying or parsing.
+///
+/// The format uses the native byte order and is versioned.
+/// Files of other versions are rejected and need to be regenerated.
+///
+class polyhedral_surface_cache {
+ public:
+  static constexpr uint32 version = 3;
+
+  // Modification time and size of the source file.
+  // Caches are only valid as long as these do not change.
+  //
+  struct stamp {
+    int64 time = 0;
+    uint64 size = 0;
+
+    bool operator==(const stamp&) const noexcept = default;
+  };
+
+  enum class section : uint32 {
+    vertices,
+    faces,
+    offsets,
+    targets,
+    halfedges,
+    twins,
+    one_ring_offsets,
+    one_ring_vertices,
+    one_ring_faces,
+    neighbor_count,
+    mean_edge_length,
+    max_edge_length,
+    ambient_occlusion,
+    count
+  };
+
+  /// Return the stamp of the given source file.
+  ///
+  static auto stamp_of(const filesystem::path& path) -> stamp;
+
+  /// Return the path of the cache file for the given source file.
+  /// The name is derived from the source's absolute path.
+  ///
+  static auto path_for(const filesystem::path& source) -> filesystem::path;
+
+  /// Write the surface with all its generated edge data
+  /// and its baked per-vertex attributes to `path`.
+  ///
+  static void write(const filesystem::path& path,
+                    const polyhedral_surface& surface,
+                    const stamp& source);
+
+  /// Map and validate the cache file given by `path`.
+  /// Throws `std::runtime_error` if the file is no valid cache.
+  ///
+  explicit polyhedral_surface_cache(const filesystem::path& path);
+
+  auto source() const noexcept -> const stamp& { return _source; }
+
+  auto vertices() const noexcept {
+    return view<polyhedral_surface::vertex>(section::vertices);
+  }
+  auto faces() const noexcept {
+    return view<polyhedral_surface::face>(section::faces);
+  }
+  auto offsets() const noexcept { return view<uint32>(section::offsets); }
+  auto targets() const noexcept { return view<uint32>(section::targets); }
+  auto halfedges() const noexcept { return view<uint32>(section::halfedges); }
+  auto twins() const noexcept { return view<uint32>(section::twins); }
+  auto one_ring_offsets() const noexcept {
+    return view<uint32>(section::one_ring_offsets);
+  }
+  auto one_ring_vertices() const noexcept {
+    return view<uint32>(section::one_ring_vertices);
+  }
+  auto one_ring_faces() const noexcept {
+    return view<uint32>(section::one_ring_faces);
+  }
+  auto neighbor_count() const noexcept {
+    return view<uint64>(section::neighbor_count);
+  }
+  auto mean_edge_length() const noexcept {
+    return view<float32>(section::mean_edge_length);
+  }
+  auto max_edge_length() const noexcept {
+    return view<float32>(section::max_edge_length);
+  }
+  auto ambient_occlusion() const noexcept {
+    return view<float32>(section::ambient_occlusion);
+  }
+
+ private:
+  template <typename type>
+  auto view(section s) const noexcept -> std::span<const type> {
+    const auto& [data, size] = sections[static_cast<size_t>(s)];
+    return {reinterpret_cast<const type*>(data), size};
+  }
+
+  memory_mapped_file file{};
+  stamp _source{};
+  struct span_data {
+    const char* data = nullptr;
+    size_t size = 0;
+  };
+  array<span_data, static_cast<size_t>(section::count)> sections{};
+};
+
+/// Construct a polyhedral surface with generated edges from a cache
+/// by copying all sections in parallel.
+///
+auto polyhedral_surface_from(const polyhedral_surface_cache& cache)
+    -> polyhedral_surface;
+
+/// Overwrite the cache of the given source file with the surface,
+/// for example, after baking per-vertex attributes that later loads
+/// should reuse. The surface must have been loaded from the source
+/// while it had the given stamp. If the source has changed since then,
+/// nothing is written and `false` is returned.
+/// Throws `std::runtime_error` if the cache could not be written.
+///
+auto update_cache(const filesystem::path& source,
+                  const polyhedral_surface_cache::stamp& stamp,
+                  const polyhedral_surface& surface) -> bool;
+
+}  // namespace ensketch::sandbox
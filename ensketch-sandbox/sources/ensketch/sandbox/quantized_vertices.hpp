@@ -0,0 +1,140 @@
+#pragma once
+#include <ensketch/sandbox/aabb.hpp>
+#include <ensketch/sandbox/parallel.hpp>
+
+namespace ensketch::sandbox {
+
+/// Map the unit vector `n` onto the octahedron with vertices at the unit
+/// axes and unfold its lower half onto the square [-1, 1]^2. Normals
+/// quantized in this way have an almost uniform error over the sphere.
+///
+inline auto octahedral_encode(const vec3& n) noexcept -> vec2 {
+  const auto l = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+  if (l == 0) return {0, 0};
+  const auto x = n.x / l;
+  const auto y = n.y / l;
+  if (n.z >= 0) return {x, y};
+  return {(1 - std::abs(y)) * ((x >= 0) ? 1.0f : -1.0f),
+          (1 - std::abs(x)) * ((y >= 0) ? 1.0f : -1.0f)};
+}
+
+/// Inverse of `octahedral_encode` that returns a normalized vector.
+///
+inline auto octahedral_decode(const vec2& e) noexcept -> vec3 {
+  auto x = e.x;
+  auto y = e.y;
+  const auto z = 1 - std::abs(x) - std::abs(y);
+  const auto t = std::max(-z, 0.0f);
+  x += (x >= 0) ? -t : t;
+  y += (y >= 0) ? -t : t;
+  return normalize(vec3{x, y, z});
+}
+
+/// Compact vertex with a position quantized to 16 bits per axis inside
+/// the bounding box of its mesh and an octahedral normal with 16 bits
+/// per coordinate. It takes 12 instead of 24 bytes. One unused component
+/// keeps the normal aligned to four bytes as GPUs prefer it for fetching
+/// vertex attributes. The components are read as normalized integers.
+///
+struct quantized_vertex {
+  array<uint16, 3> position;
+  uint16 unused;
+  array<int16, 2> normal;
+};
+static_assert(sizeof(quantized_vertex) == 12);
+
+/// Vertices of a mesh in compact encoding together with the bounding box
+/// that the positions have been quantized to. The error of every position
+/// coordinate is half a step, about 1/131070 of the box extent along its
+/// axis. The accessors decode single vertices on the fly.
+///
+struct quantized_vertices {
+  static constexpr float32 position_scale = 65535;
+  static constexpr float32 normal_scale = 32767;
+
+  auto size() const noexcept -> size_t { return vertices.size(); }
+
+  auto extent() const noexcept -> vec3 { return box._max - box._min; }
+
+  auto position(size_t i) const noexcept -> vec3 {
+    const auto& p = vertices[i].position;
+    return box._min + extent() * vec3{p[0], p[1], p[2]} / position_scale;
+  }
+
+  auto normal(size_t i) const noexcept -> vec3 {
+    const auto& n = vertices[i].normal;
+    return octahedral_decode(
+        vec2{std::max(n[0] / normal_scale, -1.0f),
+             std::max(n[1] / normal_scale, -1.0f)});
+  }
+
+  aabb3 box{};
+  vector<quantized_vertex> vertices{};
+};
+
+/// Constructor Extension for Quantized Vertices
+/// Every vertex type with the members `position` and `normal`
+/// can be encoded. Vertices are encoded in parallel.
+///
+auto quantized_vertices_from(const auto& vertices) -> quantized_vertices {
+  quantized_vertices result{};
+  const auto n = std::ranges::size(vertices);
+  result.vertices.resize(n);
+  if (n == 0) return result;
+
+  result.box = aabb_from(vertices[0].position);
+  for (size_t i = 1; i < n; ++i)
+    result.box = aabb(result.box, vertices[i].position);
+
+  // Degenerate axes are mapped to zero.
+  //
+  const auto extent = result.extent();
+  const auto factor = [](float32 x) {
+    return (x > 0) ? quantized_vertices::position_scale / x : 0.0f;
+  };
+  const vec3 scale{factor(extent.x), factor(extent.y), factor(extent.z)};
+  const auto quantize = [](float32 x, float32 s) {
+    return std::lround(std::clamp(x, -1.0f, 1.0f) * s);
+  };
+
+  parallel_for(n, [&](size_t i) {
+    const auto p = (vertices[i].position - result.box._min) * scale;
+    const auto e = octahedral_encode(vertices[i].normal);
+    auto& v = result.vertices[i];
+    for (int k = 0; k < 3; ++k)
+      v.position[k] = uint16(std::lround(
+          std::clamp(p[k], 0.0f, quantized_vertices::position_scale)));
+    v.unused = 0;
+    v.normal = {int16(quantize(e.x, quantized_vertices::normal_scale)),
+                int16(quantize(e.y, quantized_vertices::normal_scale))};
+  });
+  return result;
+}
+
+/// GLSL functions for vertex shaders that decode vertex attributes in
+/// the same way as `quantized_vertices`. Quantized positions have to be
+/// bound as normalized unsigned shorts and quantized normals as normalized
+/// shorts. If `quantized` is not set, all attributes are passed through.
+/// Hence, the same shaders serve both encodings.
+///
+constexpr czstring quantized_vertex_decoding = R"##(
+uniform bool quantized = false;
+uniform vec3 quantization_origin;
+uniform vec3 quantization_extent;
+
+vec3 decode_position(vec3 p) {
+  if (!quantized) return p;
+  return quantization_origin + quantization_extent * p;
+}
+
+vec3 decode_normal(vec3 n) {
+  if (!quantized) return n;
+  vec3 v = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+  float t = max(-v.z, 0.0);
+  v.x += (v.x >= 0.0) ? -t : t;
+  v.y += (v.y >= 0.0) ? -t : t;
+  return normalize(v);
+}
+)##";
+
+}  // namespace ensketch::sandbox
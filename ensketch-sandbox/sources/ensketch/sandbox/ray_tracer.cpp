@@ -1,4 +1,7 @@
 #include <ensketch/sandbox/ray_tracer.hpp>
+//
+#include <ensketch/sandbox/morton.hpp>
+#include <ensketch/sandbox/parallel.hpp>
 
 namespace ensketch::sandbox {
 
@@ -18,20 +21,306 @@ auto intersection(const ray& r, const triangle& f) noexcept
   return {u, v, t};
 }
 
+namespace {
+
+// Möller-Trumbore test on packs
+// in the same order of operations as the scalar version.
+//
+auto intersection(const simd::vec3_pack& origin,
+                  const simd::vec3_pack& direction,
+                  const simd::vec3_pack& v0,
+                  const simd::vec3_pack& edge1,
+                  const simd::vec3_pack& edge2) noexcept
+    -> ray_triangle_packet_intersection {
+  using namespace simd;
+  const auto p = cross(direction, edge2);
+  const auto determinant = dot(edge1, p);
+  const auto inverse_determinant = broadcast(1.0f) / determinant;
+  const auto s = origin - v0;
+  const auto u = dot(s, p) * inverse_determinant;
+  const auto q = cross(s, edge1);
+  const auto v = dot(direction, q) * inverse_determinant;
+  const auto t = dot(edge2, q) * inverse_determinant;
+  const auto zero = broadcast(0.0f);
+  const auto hit = (determinant != zero) & (u >= zero) & (v >= zero) &
+                   (u + v <= broadcast(1.0f)) & (t > zero);
+  ray_triangle_packet_intersection result{};
+  result.mask = mask_of(hit);
+  store(result.u.data(), u);
+  store(result.v.data(), v);
+  store(result.t.data(), t);
+  return result;
+}
+
+auto load(const array<float32, simd::width> (&data)[3]) noexcept
+    -> simd::vec3_pack {
+  return {simd::load(data[0].data()), simd::load(data[1].data()),
+          simd::load(data[2].data())};
+}
+
+auto triangle_of(const polyhedral_surface& surface, uint32 fid) noexcept
+    -> triangle {
+  const auto& v = surface.vertices;
+  const auto& f = surface.faces[fid];
+  return {v[f[0]].position, v[f[1]].position, v[f[2]].position};
+}
+
+// Accumulates the closest hit of one ray over faces tested in packets.
+// Equal distances are resolved in favor of the smaller face index.
+// So, the result does not depend on the order in which faces are tested.
+//
+struct closest_hit {
+  void test(const ray& r) noexcept {
+    auto hits = intersection(r, packet);
+    for (auto mask = hits.mask; mask; mask &= mask - 1) {
+      const auto lane = std::countr_zero(mask);
+      const auto fid = faces[lane];
+      const auto t = hits.t[lane];
+      if ((t > result.t) || ((t == result.t) && (fid > result.f))) continue;
+      static_cast<ray_triangle_intersection&>(result) = hits[lane];
+      result.f = fid;
+    }
+    size = 0;
+  }
+
+  // Add a face to the packet and test the packet once it is full.
+  //
+  void push(const ray& r, const triangle& t, uint32 fid) noexcept {
+    packet.set(size, t);
+    faces[size] = fid;
+    if (++size == triangle_packet::size) test(r);
+  }
+
+  // Test the remaining faces. Unused lanes are made degenerate.
+  //
+  void flush(const ray& r) noexcept {
+    if (size == 0) return;
+    for (auto lane = size; lane < triangle_packet::size; ++lane)
+      packet.set(lane, triangle{});
+    test(r);
+  }
+
+  ray_polyhedral_surface_intersection result{};
+  triangle_packet packet{};
+  array<uint32, triangle_packet::size> faces{};
+  size_t size = 0;
+};
+
+}  // namespace
+
+auto intersection(const ray& r, const triangle_packet& f) noexcept
+    -> ray_triangle_packet_intersection {
+  return intersection(simd::broadcast(r.origin), simd::broadcast(r.direction),
+                      load(f.origin), load(f.edge1), load(f.edge2));
+}
+
+auto intersection(const ray_packet& r, const triangle& f) noexcept
+    -> ray_triangle_packet_intersection {
+  return intersection(load(r.origin), load(r.direction),
+                      simd::broadcast(f[0]), simd::broadcast(f[1] - f[0]),
+                      simd::broadcast(f[2] - f[0]));
+}
+
 auto intersection(const ray& r, const polyhedral_surface& surface) noexcept
     -> ray_polyhedral_surface_intersection {
-  ray_polyhedral_surface_intersection result{};
+  closest_hit hit{};
+  hit.result.t = infinity;
+  for (size_t i = 0; i < surface.faces.size(); ++i)
+    hit.push(r, triangle_of(surface, i), i);
+  hit.flush(r);
+  return hit.result;
+}
+
+namespace {
+
+// Return the interval of ray parameters inside the box clipped to
+// [t_min, t_max]. It is empty if its first value exceeds its second one.
+// Rays that run inside a bounding plane of the box have a zero direction
+// component and give NaN values along that axis. Comparisons with NaN
+// are false. So, NaN never replaces a bound and the axis is ignored.
+//
+inline auto slab_interval(const ray& r,
+                          const vec3& inverse_direction,
+                          const aabb3& box,
+                          float32 t_min,
+                          float32 t_max) noexcept -> pair<float32, float32> {
+  for (int k = 0; k < 3; ++k) {
+    auto t0 = (box._min[k] - r.origin[k]) * inverse_direction[k];
+    auto t1 = (box._max[k] - r.origin[k]) * inverse_direction[k];
+    if (t1 < t0) swap(t0, t1);
+    if (t0 > t_min) t_min = t0;
+    if (t1 < t_max) t_max = t1;
+  }
+  return {t_min, t_max};
+}
+
+// BVH traversal for any kind of triangles.
+// `triangle_of` maps a primitive index to its triangle.
+//
+auto intersection(const ray& r, const bvh& tree, auto&& triangle_of) noexcept
+    -> ray_polyhedral_surface_intersection {
+  closest_hit hit{};
+  auto& result = hit.result;
   result.t = infinity;
-  for (size_t i = 0; i < surface.faces.size(); ++i) {
-    const auto& v = surface.vertices;
-    const auto& f = surface.faces[i];
-    if (const auto p = intersection(
-            r, {v[f[0]].position, v[f[1]].position, v[f[2]].position})) {
-      if (p.t >= result.t) continue;
-      static_cast<ray_triangle_intersection&>(result) = p;
-      result.f = i;
+  if (tree.empty()) return result;
+
+  // Slab test that returns the distance at which the ray enters the box
+  // or infinity if the box is missed or farther than the current hit.
+  //
+  const auto inverse_direction = 1.0f / r.direction;
+  const auto entry = [&](const aabb3& box) {
+    const auto [t_near, t_far] =
+        slab_interval(r, inverse_direction, box, 0.0f, result.t);
+    return (t_near <= t_far) ? t_near : infinity;
+  };
+
+  // Children are visited front to back. The farther child is put
+  // on the stack together with its entry distance to be able
+  // to skip it if a closer intersection has been found in between.
+  //
+  array<pair<uint32, float32>, bvh::max_depth> stack;
+  size_t size = 0;
+  if (entry(tree.root().box) < infinity) stack[size++] = {0, 0.0f};
+  while (size > 0) {
+    const auto [index, t] = stack[--size];
+    if (t > result.t) continue;
+    const auto& node = tree.nodes[index];
+
+    if (node.is_leaf()) {
+      for (auto i = node.offset; i < node.offset + node.count; ++i) {
+        const auto fid = tree.primitives[i];
+        hit.push(r, triangle_of(fid), fid);
+      }
+      hit.flush(r);
+      continue;
+    }
+
+    auto near = pair{node.offset, entry(tree.nodes[node.offset].box)};
+    auto far = pair{node.offset + 1, entry(tree.nodes[node.offset + 1].box)};
+    if (far.second < near.second) swap(near, far);
+    if (far.second < infinity) stack[size++] = far;
+    if (near.second < infinity) stack[size++] = near;
+  }
+  return result;
+}
+
+}  // namespace
+
+auto intersection(const ray& r,
+                  const polyhedral_surface& surface,
+                  const bvh& tree) noexcept
+    -> ray_polyhedral_surface_intersection {
+  return intersection(
+      r, tree, [&](uint32 fid) { return triangle_of(surface, fid); });
+}
+
+auto intersection(const ray& r,
+                  std::span<const vec3> positions,
+                  std::span<const scene::mesh::face> faces,
+                  const bvh& tree) noexcept
+    -> ray_polyhedral_surface_intersection {
+  return intersection(r, tree, [&](uint32 fid) {
+    const auto& f = faces[fid];
+    return triangle{positions[f[0]], positions[f[1]], positions[f[2]]};
+  });
+}
+
+bool occluded(const ray& r,
+              const polyhedral_surface& surface,
+              const bvh& tree,
+              float32 t_max) noexcept {
+  if (tree.empty()) return false;
+
+  const auto inverse_direction = 1.0f / r.direction;
+  const auto hits = [&](const aabb3& box) {
+    const auto [t_near, t_far] =
+        slab_interval(r, inverse_direction, box, 0.0f, t_max);
+    return t_near <= t_far;
+  };
+
+  // Faces are still tested in packets. Unused lanes are made degenerate.
+  //
+  triangle_packet packet{};
+  size_t count = 0;
+  const auto test = [&] {
+    for (auto lane = count; lane < triangle_packet::size; ++lane)
+      packet.set(lane, triangle{});
+    count = 0;
+    const auto hits = intersection(r, packet);
+    for (auto mask = hits.mask; mask; mask &= mask - 1)
+      if (hits.t[std::countr_zero(mask)] < t_max) return true;
+    return false;
+  };
+
+  array<uint32, bvh::max_depth> stack;
+  size_t size = 0;
+  if (hits(tree.root().box)) stack[size++] = 0;
+  while (size > 0) {
+    const auto& node = tree.nodes[stack[--size]];
+    if (node.is_leaf()) {
+      for (auto i = node.offset; i < node.offset + node.count; ++i) {
+        packet.set(count++, triangle_of(surface, tree.primitives[i]));
+        if ((count == triangle_packet::size) && test()) return true;
+      }
+      if ((count > 0) && test()) return true;
+      continue;
     }
+    if (hits(tree.nodes[node.offset + 1].box)) stack[size++] = node.offset + 1;
+    if (hits(tree.nodes[node.offset].box)) stack[size++] = node.offset;
   }
+  return false;
+}
+
+auto nearest_vertex(const polyhedral_surface& surface,
+                    const ray_polyhedral_surface_intersection& p) noexcept
+    -> polyhedral_surface::vertex_id {
+  if (!p) return polyhedral_surface::invalid;
+
+  const auto& f = surface.faces[p.f];
+  const auto w = 1.0f - p.u - p.v;
+
+  const auto position = surface.vertices[f[0]].position * w +
+                        surface.vertices[f[1]].position * p.u +
+                        surface.vertices[f[2]].position * p.v;
+
+  const auto l0 = length(position - surface.vertices[f[0]].position);
+  const auto l1 = length(position - surface.vertices[f[1]].position);
+  const auto l2 = length(position - surface.vertices[f[2]].position);
+
+  if (l0 <= l1) return (l0 <= l2) ? f[0] : f[2];
+  return (l1 <= l2) ? f[1] : f[2];
+}
+
+auto intersections(const opengl::camera& camera,
+                   std::span<const vec2> points,
+                   const polyhedral_surface& surface,
+                   const bvh& tree) -> vector<screen_point_intersection> {
+  // Sort the points by their Morton code on the pixel grid.
+  // The radix sort is stable. So, equal pixels keep their order.
+  //
+  vector<uint32> keys(points.size());
+  vector<uint32> order(points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    const auto x = uint32(std::clamp(points[i].x, 0.0f, 65535.0f));
+    const auto y = uint32(std::clamp(points[i].y, 0.0f, 65535.0f));
+    keys[i] = morton_code(x, y);
+    order[i] = i;
+  }
+  parallel_radix_sort(keys, order);
+
+  vector<screen_point_intersection> result(points.size());
+  parallel_for(
+      points.size(),
+      [&](size_t i) {
+        const auto j = order[i];
+        const auto r = primary_ray(camera, points[j].x, points[j].y);
+        auto& hit = result[j];
+        static_cast<ray_polyhedral_surface_intersection&>(hit) =
+            intersection(r, surface, tree);
+        hit.vertex = nearest_vertex(surface, hit);
+      },
+      // A single ray already takes microseconds.
+      size_t{64});
   return result;
 }
 
@@ -1,5 +1,7 @@
 #pragma once
+#include <ensketch/sandbox/bvh.hpp>
 #include <ensketch/sandbox/polyhedral_surface.hpp>
+#include <ensketch/sandbox/simd.hpp>
 #include <ensketch/sandbox/utility.hpp>
 //
 #include <ensketch/opengl/camera.hpp>
@@ -28,6 +30,69 @@ struct ray_triangle_intersection {
 auto intersection(const ray& r, const triangle& f) noexcept
     -> ray_triangle_intersection;
 
+/// Triangles in structure-of-arrays layout with one SIMD lane per triangle.
+/// Lanes that have not been set stay degenerate and are never hit.
+///
+struct triangle_packet {
+  static constexpr size_t size = simd::width;
+
+  void set(size_t lane, const triangle& f) noexcept {
+    for (int k = 0; k < 3; ++k) {
+      origin[k][lane] = f[0][k];
+      edge1[k][lane] = f[1][k] - f[0][k];
+      edge2[k][lane] = f[2][k] - f[0][k];
+    }
+  }
+
+  array<float32, size> origin[3]{};
+  array<float32, size> edge1[3]{};
+  array<float32, size> edge2[3]{};
+};
+
+/// Rays in structure-of-arrays layout with one SIMD lane per ray.
+/// Lanes that have not been set have no direction and never hit anything.
+///
+struct ray_packet {
+  static constexpr size_t size = simd::width;
+
+  void set(size_t lane, const ray& r) noexcept {
+    for (int k = 0; k < 3; ++k) {
+      origin[k][lane] = r.origin[k];
+      direction[k][lane] = r.direction[k];
+    }
+  }
+
+  array<float32, size> origin[3]{};
+  array<float32, size> direction[3]{};
+};
+
+/// Lane-wise results of the SIMD intersection kernels.
+/// Bit `i` of `mask` is set if and only if lane `i` has been hit.
+/// The parameters of all other lanes are meaningless.
+///
+struct ray_triangle_packet_intersection {
+  auto operator[](size_t lane) const noexcept -> ray_triangle_intersection {
+    return {u[lane], v[lane], t[lane]};
+  }
+
+  uint32 mask{};
+  array<float32, simd::width> u{};
+  array<float32, simd::width> v{};
+  array<float32, simd::width> t{};
+};
+
+/// Test one ray against all triangles of a packet at once.
+/// The operations are the same as for the scalar test. So, results only
+/// differ by rounding if the compiler contracts them to fused operations.
+///
+auto intersection(const ray& r, const triangle_packet& f) noexcept
+    -> ray_triangle_packet_intersection;
+
+/// Test all rays of a packet against one triangle at once.
+///
+auto intersection(const ray_packet& r, const triangle& f) noexcept
+    -> ray_triangle_packet_intersection;
+
 struct ray_polyhedral_surface_intersection : ray_triangle_intersection {
   // We overwrite the check,
   // because it the triangle will already have been checked.
@@ -38,6 +103,62 @@ struct ray_polyhedral_surface_intersection : ray_triangle_intersection {
 auto intersection(const ray& r, const polyhedral_surface& scene) noexcept
     -> ray_polyhedral_surface_intersection;
 
+/// Find the closest intersection of a ray with a polyhedral surface
+/// by traversing a BVH that has been built over the surface's faces.
+/// The result is the same as for the linear scan over all faces.
+///
+auto intersection(const ray& r,
+                  const polyhedral_surface& surface,
+                  const bvh& tree) noexcept
+    -> ray_polyhedral_surface_intersection;
+
+/// Find the closest intersection of a ray with the triangles given by
+/// vertex positions and faces by traversing a BVH built over the faces.
+/// This is used for meshes whose vertices are transformed on the fly,
+/// like skinned meshes in an animated pose.
+///
+auto intersection(const ray& r,
+                  std::span<const vec3> positions,
+                  std::span<const scene::mesh::face> faces,
+                  const bvh& tree) noexcept
+    -> ray_polyhedral_surface_intersection;
+
+/// Check whether the ray hits any face of the surface closer than `t_max`.
+/// The traversal stops at the first such hit and neither sorts children
+/// nor determines the closest hit. This is all that shadow and occlusion
+/// rays need and much cheaper than `intersection`.
+///
+bool occluded(const ray& r,
+              const polyhedral_surface& surface,
+              const bvh& tree,
+              float32 t_max) noexcept;
+
+/// Return the vertex of the intersected face
+/// that is closest to the point of intersection.
+/// Return `polyhedral_surface::invalid` if nothing has been hit.
+///
+auto nearest_vertex(const polyhedral_surface& surface,
+                    const ray_polyhedral_surface_intersection& p) noexcept
+    -> polyhedral_surface::vertex_id;
+
+/// Intersection of a primary ray through a point on the screen.
+///
+struct screen_point_intersection : ray_polyhedral_surface_intersection {
+  polyhedral_surface::vertex_id vertex = polyhedral_surface::invalid;
+};
+
+/// Cast primary rays through all given screen points and intersect
+/// them with the surface by traversing its BVH. The rays are processed
+/// in Morton order of their screen points and distributed over all
+/// threads in consecutive chunks. So, every thread traverses coherent
+/// rays that mostly visit the same nodes. The results are returned
+/// in the order of the given points.
+///
+auto intersections(const opengl::camera& camera,
+                   std::span<const vec2> points,
+                   const polyhedral_surface& surface,
+                   const bvh& tree) -> vector<screen_point_intersection>;
+
 inline auto primary_ray(const opengl::camera& camera, float x, float y) noexcept
     -> ray {
   return ray{
@@ -48,4 +169,17 @@ inline auto primary_ray(const opengl::camera& camera, float x, float y) noexcept
                      (0.5f * camera.screen_height() - y) * camera.up()))};
 }
 
+/// Inverse of `primary_ray` that maps a point to the coordinates
+/// of the screen. Points behind the camera have no screen position.
+///
+inline auto screen_position(const opengl::camera& camera,
+                            const vec3& p) noexcept -> optional<vec2> {
+  const auto d = p - camera.position();
+  const auto z = dot(d, camera.direction());
+  if (z <= 0.0f) return nullopt;
+  const auto scale = 1.0f / (z * camera.pixel_size());
+  return vec2{0.5f * camera.screen_width() + scale * dot(d, camera.right()),
+              0.5f * camera.screen_height() - scale * dot(d, camera.up())};
+}
+
 }  // namespace ensketch::sandbox
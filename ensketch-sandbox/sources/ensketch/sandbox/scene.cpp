@@ -1,6 +1,9 @@
 #include <ensketch/sandbox/scene.hpp>
 //
+#include <ensketch/sandbox/cache.hpp>
 #include <ensketch/sandbox/log.hpp>
+#include <ensketch/sandbox/parallel.hpp>
+#include <ensketch/sandbox/scene_cache.hpp>
 //
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -48,9 +51,11 @@ static void load(const aiMesh* in, scene::mesh& out) {
 }
 
 static void load_meshes(const aiScene* in, scene& out) {
+  // Meshes are independent and may vary strongly in size.
   out.meshes.resize(in->mNumMeshes);
-  for (size_t mid = 0; mid < in->mNumMeshes; ++mid)
+  parallel_for_dynamic(in->mNumMeshes, [&](size_t mid) {
     load(in->mMeshes[mid], out.meshes[mid]);
+  });
 }
 
 static void load(const aiNode* in,
@@ -80,28 +85,84 @@ static void update_node_name_map(scene& s) {
   });
 }
 
+// Restore all references to the root node after it has been moved
+// from `old_root`. All other nodes are stored inside `std::list`
+// containers and keep their addresses.
+//
+static void relink(scene& s, const scene::node* old_root) {
+  for (auto& child : s.root.children) child.parent = &s.root;
+  update_node_name_map(s);
+  for (auto& node : s.skeleton.nodes)
+    if (node == old_root) node = &s.root;
+  // The keys of the bone name map view node names which
+  // may have been moved together with the root.
+  s.skeleton.bone_name_map.clear();
+  for (uint32 bid = 0; bid < s.skeleton.nodes.size(); ++bid)
+    s.skeleton.bone_name_map.emplace(s.skeleton.nodes[bid]->name, bid);
+}
+
+scene::scene(scene&& x)
+    : name{std::move(x.name)},
+      meshes{std::move(x.meshes)},
+      root{std::move(x.root)},
+      node_count{x.node_count},
+      animations{std::move(x.animations)},
+      skeleton{std::move(x.skeleton)} {
+  x.node_name_map.clear();
+  relink(*this, &x.root);
+}
+
+scene& scene::operator=(scene&& x) {
+  name = std::move(x.name);
+  meshes = std::move(x.meshes);
+  root = std::move(x.root);
+  node_count = x.node_count;
+  animations = std::move(x.animations);
+  skeleton = std::move(x.skeleton);
+  x.node_name_map.clear();
+  relink(*this, &x.root);
+  return *this;
+}
+
 static void load_bone_entries(const aiScene* in, scene& out) {
+  // Bone entries are created serially in the order of meshes and bones.
+  // So, the order of entries inside every node and the overwriting
+  // of node offsets stay the same as for a fully serial conversion.
+  // Entries are referenced by index as vectors may still reallocate.
+  //
+  struct task {
+    const aiBone* bone;
+    scene::node* node;
+    size_t entry;
+  };
+  std::vector<task> tasks{};
   for (size_t mid = 0; mid < in->mNumMeshes; ++mid) {
     auto mesh = in->mMeshes[mid];
     for (size_t bid = 0; bid < mesh->mNumBones; ++bid) {
       auto bone = mesh->mBones[bid];
       auto& node = out.node_name_map.at(bone->mName.C_Str());
       node.offset = mat4_from(bone->mOffsetMatrix);
-      auto& entry = node.bone_entries.emplace_back(mid);
-      entry.weights.reserve(bone->mNumWeights);
-      for (size_t wid = 0; wid < bone->mNumWeights; ++wid) {
-        const auto vid = bone->mWeights[wid].mVertexId;
-        const float weight = bone->mWeights[wid].mWeight;
-        entry.weights.emplace_back(vid, weight);
-      }
+      node.bone_entries.emplace_back(mid);
+      tasks.push_back({bone, &node, node.bone_entries.size() - 1});
     }
   }
+
+  // Afterwards, the weights of all bones are copied in parallel.
+  parallel_for_dynamic(tasks.size(), [&](size_t i) {
+    const auto [bone, node, index] = tasks[i];
+    auto& entry = node->bone_entries[index];
+    entry.weights.reserve(bone->mNumWeights);
+    for (size_t wid = 0; wid < bone->mNumWeights; ++wid) {
+      const auto vid = bone->mWeights[wid].mVertexId;
+      const float weight = bone->mWeights[wid].mWeight;
+      entry.weights.emplace_back(vid, weight);
+    }
+  });
 }
 
 static void load_hierarchy(const aiScene* in, scene& out) {
   load(in->mRootNode, out.root, out.node_count);
   update_node_name_map(out);
-  load_bone_entries(in, out);
 }
 
 auto scene::animation::channel::position(float64 time) const -> glm::mat4 {
@@ -180,22 +241,25 @@ static void load(const aiNodeAnim* in, scene::animation::channel& out) {
         {in->mScalingKeys[i].mTime, vec3_from(in->mScalingKeys[i].mValue)});
 }
 
-static void load(const aiAnimation* in, scene::animation& out) {
-  // Name
-  out.name = in->mName.C_Str();
-  // Duration
-  out.duration = in->mDuration;
-  out.ticks = in->mTicksPerSecond;
-  // Bone Animation Channels
-  out.channels.resize(in->mNumChannels);
-  for (size_t i = 0; i < in->mNumChannels; ++i)
-    load(in->mChannels[i], out.channels[i]);
-}
-
 static void load_animations(const aiScene* in, scene& out) {
+  // Channels are allocated first to convert
+  // them in parallel across all animations.
+  std::vector<std::pair<const aiNodeAnim*, scene::animation::channel*>>
+      channels{};
   out.animations.resize(in->mNumAnimations);
-  for (size_t i = 0; i < in->mNumAnimations; ++i)
-    load(in->mAnimations[i], out.animations[i]);
+  for (size_t i = 0; i < in->mNumAnimations; ++i) {
+    const auto animation = in->mAnimations[i];
+    auto& result = out.animations[i];
+    result.name = animation->mName.C_Str();
+    result.duration = animation->mDuration;
+    result.ticks = animation->mTicksPerSecond;
+    result.channels.resize(animation->mNumChannels);
+    for (size_t j = 0; j < animation->mNumChannels; ++j)
+      channels.emplace_back(animation->mChannels[j], &result.channels[j]);
+  }
+  parallel_for_dynamic(channels.size(), [&](size_t i) {
+    load(channels[i].first, *channels[i].second);
+  });
 }
 
 static void traverse_skeleton_nodes(scene& s,
@@ -246,13 +310,6 @@ static void update_skeleton(scene& s) {
   }
 }
 
-static void load(const aiScene* in, scene& out) {
-  out.name = in->mName.C_Str();
-  load_meshes(in, out);
-  load_hierarchy(in, out);
-  load_animations(in, out);
-}
-
 auto scene_from_file(const std::filesystem::path& path) -> scene {
   // Generate functor for prefixed error messages.
   const auto throw_error = [&](czstring str) {
@@ -263,7 +320,15 @@ auto scene_from_file(const std::filesystem::path& path) -> scene {
   // Check for file existence to receive more valuable error messages.
   if (!exists(path)) throw_error("The path does not exist.");
 
-  Assimp::Importer importer{};
+  // Measure every stage of the load to find bottlenecks.
+  auto start = clock::now();
+  const auto stage = [&start](czstring name) {
+    const auto end = clock::now();
+    log::info(std::format("  {:<14}{:>10.3f} s", name,
+                          duration(end - start).count()));
+    start = end;
+  };
+  log::info(std::format("Loading scene from '{}'.", path.string()));
 
   // After the stripping and loading,
   // certain post processing steps are mandatory.
@@ -272,18 +337,73 @@ auto scene_from_file(const std::filesystem::path& path) -> scene {
       aiProcess_JoinIdenticalVertices | aiProcess_RemoveComponent |
       /*aiProcess_OptimizeMeshes |*/ /*aiProcess_OptimizeGraph |*/
       aiProcess_FindDegenerates /*| aiProcess_DropNormals*/;
+  const bool preserve_pivots = false;
+
+  // Imports are cached by the hash of the file content and import settings.
+  // So, renaming or copying files does not invalidate the cache
+  // whereas any change of the content or the settings does.
+  // Only the given file itself is hashed. Changes to files it references,
+  // like external buffers of glTF files, are not detected.
+  //
+  std::filesystem::path cache_path{};
+  try {
+    const auto settings = std::format("{}:{}:{}", scene_cache_version,
+                                      uint32(post_processing), preserve_pivots);
+    const auto key = fnv1a_hash(settings, content_hash_of(path));
+    cache_path = cache_directory() / std::format("{:016x}.scene", key);
+  } catch (std::runtime_error& e) {
+    log::warn(e.what());
+  }
+  stage("content hash");
+
+  scene out{};
 
-  importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, false);
+  if (!cache_path.empty() && exists(cache_path)) {
+    try {
+      read_scene_cache(cache_path, out);
+      update_node_name_map(out);
+      update_skeleton(out);
+      stage("cache read");
+      return out;
+    } catch (std::runtime_error& e) {
+      log::warn(e.what());
+      out = scene{};
+    }
+  }
+
+  Assimp::Importer importer{};
+  importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS,
+                           preserve_pivots);
 
   const auto in = importer.ReadFile(path.c_str(), post_processing);
 
   // Check whether Assimp could load the file at all.
   if (!in || in->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !in->mRootNode)
     throw_error("Assimp could not process the file.");
+  stage("assimp");
 
-  scene out{};
-  load(in, out);
+  out.name = in->mName.C_Str();
+  load_meshes(in, out);
+  stage("meshes");
+  load_hierarchy(in, out);
+  stage("hierarchy");
+  load_bone_entries(in, out);
+  stage("bone entries");
+  load_animations(in, out);
+  stage("animations");
   update_skeleton(out);
+  stage("skeleton");
+
+  // Failing to write the cache only affects later loads.
+  if (!cache_path.empty()) {
+    try {
+      write_scene_cache(cache_path, out);
+      stage("cache write");
+    } catch (std::runtime_error& e) {
+      log::warn(e.what());
+    }
+  }
+
   return out;
 }
 
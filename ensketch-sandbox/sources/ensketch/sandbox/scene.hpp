@@ -125,6 +125,19 @@ struct scene {
     }
   };
 
+  scene() = default;
+
+  // Nodes are referenced by parent pointers, the node name map,
+  // and the skeleton. Only the root node changes its address
+  // when moving. So, moving relinks all references to the root.
+  // Relinking rebuilds the name maps and may throw `std::bad_alloc`.
+  // Copying is NOT allowed.
+  //
+  scene(scene&& x);
+  scene& operator=(scene&& x);
+  scene(const scene&) = delete;
+  scene& operator=(const scene&) = delete;
+
   std::string name{};
   std::vector<mesh> meshes{};
   node root{};
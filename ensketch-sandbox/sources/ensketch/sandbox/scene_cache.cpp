@@ -0,0 +1,224 @@
+#include <ensketch/sandbox/scene_cache.hpp>
+//
+#include <ensketch/sandbox/cache.hpp>
+#include <ensketch/sandbox/memory_mapped_file.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+constexpr std::array<char, 8> magic{'E', 'N', 'S', 'K', 'S', 'C', 'E', 'N'};
+
+// All values are written in native byte order without any padding
+// between them. Arrays of trivially copyable types are stored as
+// their element count followed by their raw bytes.
+//
+struct writer {
+  template <typename type>
+    requires std::is_trivially_copyable_v<type>
+  void write(const type& value) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(type));
+  }
+
+  template <typename type>
+    requires std::is_trivially_copyable_v<type>
+  void write(const std::vector<type>& data) {
+    write(uint64(data.size()));
+    stream.write(reinterpret_cast<const char*>(data.data()),
+                 data.size() * sizeof(type));
+  }
+
+  void write(const std::string& str) {
+    write(uint64(str.size()));
+    stream.write(str.data(), str.size());
+  }
+
+  void write(const scene::mesh& mesh) {
+    write(mesh.name);
+    write(mesh.vertices);
+    write(mesh.faces);
+  }
+
+  void write(const scene::node& node) {
+    write(node.name);
+    write(node.offset);
+    write(node.transform);
+    write(node.meshes);
+    write(uint64(node.bone_entries.size()));
+    for (const auto& entry : node.bone_entries) {
+      write(entry.mesh);
+      write(entry.weights);
+    }
+    write(uint64(node.children.size()));
+    for (const auto& child : node.children) write(child);
+  }
+
+  void write(const scene::animation& animation) {
+    write(animation.name);
+    write(animation.duration);
+    write(animation.ticks);
+    write(uint64(animation.channels.size()));
+    for (const auto& channel : animation.channels) {
+      write(channel.node_name);
+      write(channel.positions);
+      write(channel.rotations);
+      write(channel.scalings);
+    }
+  }
+
+  std::ostream& stream;
+};
+
+// The reader checks every access against the remaining bytes.
+// So, truncated or corrupted files never lead to out-of-bounds reads
+// or huge allocations. Indices are read as raw values and have to be
+// checked by `check_indices` afterwards.
+//
+struct reader {
+  void read(void* data, size_t size) {
+    if (size > bytes.size())
+      throw std::runtime_error("The file is truncated.");
+    std::memcpy(data, bytes.data(), size);
+    bytes.remove_prefix(size);
+  }
+
+  auto count(size_t element_size) -> size_t {
+    const auto result = value<uint64>();
+    if (result > bytes.size() / std::max<size_t>(element_size, 1))
+      throw std::runtime_error("The file is truncated.");
+    return result;
+  }
+
+  template <typename type>
+    requires std::is_trivially_copyable_v<type>
+  auto value() -> type {
+    type result;
+    read(&result, sizeof(type));
+    return result;
+  }
+
+  template <typename type>
+    requires std::is_trivially_copyable_v<type>
+  void read(type& x) {
+    read(&x, sizeof(type));
+  }
+
+  template <typename type>
+    requires std::is_trivially_copyable_v<type>
+  void read(std::vector<type>& data) {
+    data.resize(count(sizeof(type)));
+    read(data.data(), data.size() * sizeof(type));
+  }
+
+  void read(std::string& str) {
+    str.resize(count(1));
+    read(str.data(), str.size());
+  }
+
+  void read(scene::mesh& mesh) {
+    read(mesh.name);
+    read(mesh.vertices);
+    read(mesh.faces);
+  }
+
+  void read(scene::node& node, uint32& index, scene::node* parent) {
+    node.index = index++;
+    node.parent = parent;
+    read(node.name);
+    read(node.offset);
+    read(node.transform);
+    read(node.meshes);
+    node.bone_entries.resize(count(sizeof(uint32) + sizeof(uint64)));
+    for (auto& entry : node.bone_entries) {
+      read(entry.mesh);
+      read(entry.weights);
+    }
+    const auto children = count(1);
+    for (size_t i = 0; i < children; ++i)
+      read(node.children.emplace_back(), index, &node);
+  }
+
+  void read(scene::animation& animation) {
+    read(animation.name);
+    read(animation.duration);
+    read(animation.ticks);
+    animation.channels.resize(count(4 * sizeof(uint64)));
+    for (auto& channel : animation.channels) {
+      read(channel.node_name);
+      read(channel.positions);
+      read(channel.rotations);
+      read(channel.scalings);
+    }
+  }
+
+  std::string_view bytes;
+};
+
+// Check that all faces, nodes, and bone weights only reference
+// existing meshes and vertices. Later stages, like the construction
+// of the skeleton, index arrays with them without any checks.
+//
+void check_indices(const scene& s, const scene::node& node) {
+  for (auto mid : node.meshes)
+    if (mid >= s.meshes.size())
+      throw std::runtime_error("A node references an invalid mesh.");
+  for (const auto& entry : node.bone_entries) {
+    if (entry.mesh >= s.meshes.size())
+      throw std::runtime_error("A bone references an invalid mesh.");
+    const auto vertex_count = s.meshes[entry.mesh].vertices.size();
+    for (const auto& weight : entry.weights)
+      if (weight.vertex >= vertex_count)
+        throw std::runtime_error("A bone weight references an invalid vertex.");
+  }
+  for (const auto& child : node.children) check_indices(s, child);
+}
+
+void check_indices(const scene& s) {
+  for (const auto& mesh : s.meshes)
+    for (const auto& face : mesh.faces)
+      for (auto vid : face)
+        if (vid >= mesh.vertices.size())
+          throw std::runtime_error("A face references an invalid vertex.");
+  check_indices(s, s.root);
+}
+
+}  // namespace
+
+void write_scene_cache(const std::filesystem::path& path, const scene& s) {
+  write_file_atomically(path, [&](std::ostream& stream) {
+    writer out{stream};
+    out.write(magic);
+    out.write(scene_cache_version);
+    out.write(s.name);
+    out.write(uint64(s.meshes.size()));
+    for (const auto& mesh : s.meshes) out.write(mesh);
+    out.write(s.root);
+    out.write(uint64(s.animations.size()));
+    for (const auto& animation : s.animations) out.write(animation);
+  });
+}
+
+void read_scene_cache(const std::filesystem::path& path, scene& s) {
+  try {
+    const memory_mapped_file file{path};
+    reader in{file.view()};
+    if (in.value<std::array<char, 8>>() != magic)
+      throw std::runtime_error("The file is no scene cache.");
+    if (in.value<uint32>() != scene_cache_version)
+      throw std::runtime_error(
+          "The file has been written by a different version.");
+    in.read(s.name);
+    s.meshes.resize(in.count(3 * sizeof(uint64)));
+    for (auto& mesh : s.meshes) in.read(mesh);
+    s.node_count = 0;
+    in.read(s.root, s.node_count, nullptr);
+    s.animations.resize(in.count(3 * sizeof(uint64)));
+    for (auto& animation : s.animations) in.read(animation);
+    check_indices(s);
+  } catch (std::runtime_error& e) {
+    throw std::runtime_error(std::format(
+        "Failed to read scene cache '{}'. {}", path.string(), e.what()));
+  }
+}
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,24 @@
+#pragma once
+#include <ensketch/sandbox/scene.hpp>
+
+namespace ensketch::sandbox {
+
+/// Version of the binary scene cache format.
+/// It needs to be incremented for every change of the format
+/// or of the import settings used for scenes.
+///
+constexpr uint32 scene_cache_version = 1;
+
+/// Write the imported data of a scene to a binary cache file.
+/// Only meshes, the node hierarchy with bone entries, and animations are
+/// stored. All other members are derived data and not part of the file.
+///
+void write_scene_cache(const std::filesystem::path& path, const scene& s);
+
+/// Read the imported data of a scene from a binary cache file into `s`.
+/// The node name map and skeleton of `s` are not updated.
+/// Throws `std::runtime_error` if the file is no valid scene cache.
+///
+void read_scene_cache(const std::filesystem::path& path, scene& s);
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,41 @@
+#include <ensketch/sandbox/scene_import.hpp>
+
+namespace ensketch::sandbox {
+
+auto scene_import_from_file(const std::filesystem::path& path,
+                            uint32 representations) -> scene_import {
+  auto imported = scene_from_file(path);
+  const auto& in = imported;
+
+  // All representations only read from the imported scene.
+  // So, they can be derived concurrently without synchronization.
+  //
+  using representation = scene_import::representation;
+  scene_import out{};
+  std::vector<std::future<void>> tasks{};
+  const auto derive = [&](uint32 r, auto&& f) {
+    if (representations & r)
+      tasks.push_back(std::async(std::launch::async, f));
+  };
+  derive(representation::flat, [&] { out.flat.emplace(flat_scene_from(in)); });
+  derive(representation::surface, [&] {
+    out.surface.emplace(polyhedral_surface_from(in));
+    out.surface->generate_edges();
+  });
+  derive(representation::skeletal,
+         [&] { out.skeletal.emplace(skeletal_mesh_from(in)); });
+  derive(representation::skinned,
+         [&] { out.skinned.emplace(skinned_mesh_from(in)); });
+
+  // Wait for all tasks before rethrowing the first error.
+  // Otherwise, running tasks would reference destroyed data.
+  //
+  for (auto& task : tasks) task.wait();
+  for (auto& task : tasks) task.get();
+
+  if (representations & representation::hierarchy)
+    out.scene.emplace(std::move(imported));
+  return out;
+}
+
+}  // namespace ensketch::sandbox
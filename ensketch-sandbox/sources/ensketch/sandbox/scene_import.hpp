@@ -0,0 +1,42 @@
+#pragma once
+#include <ensketch/sandbox/flat_scene.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+#include <ensketch/sandbox/scene.hpp>
+#include <ensketch/sandbox/skeletal_mesh.hpp>
+#include <ensketch/sandbox/skinned_mesh.hpp>
+
+namespace ensketch::sandbox {
+
+/// All representations of a file that have been requested
+/// from a single import. Representations that have not been
+/// requested stay empty.
+///
+struct scene_import {
+  // Flags to select the representations
+  // that should be derived from the import.
+  //
+  struct representation {
+    static constexpr uint32 hierarchy = 1u << 0;  // the imported `scene`
+    static constexpr uint32 flat = 1u << 1;
+    static constexpr uint32 surface = 1u << 2;
+    static constexpr uint32 skeletal = 1u << 3;
+    static constexpr uint32 skinned = 1u << 4;
+  };
+
+  std::optional<sandbox::scene> scene{};
+  std::optional<sandbox::flat_scene> flat{};
+  std::optional<polyhedral_surface> surface{};
+  std::optional<sandbox::skeletal_mesh> skeletal{};
+  std::optional<sandbox::skinned_mesh> skinned{};
+};
+
+/// Import the given file once as `scene` and derive all requested
+/// representations from it in parallel. The imported scene is only
+/// kept if `representation::hierarchy` is requested. The surface comes
+/// with generated edges. Throws `std::runtime_error` if the import or
+/// the derivation of any representation fails.
+///
+auto scene_import_from_file(const std::filesystem::path& path,
+                            uint32 representations) -> scene_import;
+
+}  // namespace ensketch::sandbox
@@ -2,13 +2,17 @@
 #include <ensketch/sandbox/basic_viewer.hpp>
 #include <ensketch/sandbox/flat_scene.hpp>
 #include <ensketch/sandbox/scene.hpp>
+#include <ensketch/sandbox/scene_import.hpp>
 #include <ensketch/sandbox/skinned_mesh.hpp>
+#include <ensketch/sandbox/skinned_mesh_bvh.hpp>
 
 namespace ensketch::sandbox {
 
 ///
 ///
 class scene_viewer_state : public basic_viewer_state {
+  friend opengl_window_state;
+
  public:
   using base = basic_viewer_state;
 
@@ -342,9 +346,13 @@ void main() {
 
   void load_surface(const std::filesystem::path& path) {
     try {
-      surface = scene_from_file(path);
-
-      mesh = skinned_mesh_from(surface);
+      // Import the file only once and
+      // derive the skinned mesh in parallel.
+      using representation = scene_import::representation;
+      auto data = scene_import_from_file(
+          path, representation::hierarchy | representation::skinned);
+      surface = std::move(*data.scene);
+      mesh = std::move(*data.skinned);
 
       print_scene_info();
 
@@ -393,7 +401,9 @@ void main() {
       glBindBuffer(GL_SHADER_STORAGE_BUFFER, mesh_transforms.id());
       glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, mesh_transforms.id());
       //
-      mesh_transforms.allocate_and_initialize(global_transforms(mesh));
+      const auto transforms = global_transforms(mesh);
+      mesh_transforms.allocate_and_initialize(transforms);
+      mesh_bvh.update(mesh, transforms);
 
       // device_meshes.resize(surface.meshes.size());
       // for (size_t i = 0; i < surface.meshes.size(); ++i) {
@@ -486,8 +496,10 @@ void main() {
       const auto time =
           std::fmod(std::chrono::duration<float64>(current - start).count(),
                     mesh.animations[0].duration / mesh.animations[0].ticks);
-      mesh_transforms.allocate_and_initialize(
-          animation_transforms(mesh, 0, time));
+      const auto transforms = animation_transforms(mesh, 0, time);
+      mesh_transforms.allocate_and_initialize(transforms);
+      // Follow the animated pose on the CPU for picking.
+      mesh_bvh.update(mesh, transforms);
     }
 
     device_mesh.va.bind();
@@ -525,12 +537,31 @@ void main() {
   void use_face_normal(bool value) { shader.set("use_face_normal", value); }
 
  protected:
+  void process(const sf::Event& event) {
+    base::process(event);
+    if ((event.type == sf::Event::MouseButtonPressed) &&
+        (event.mouseButton.button == sf::Mouse::Middle))
+      look_at(event.mouseButton.x, event.mouseButton.y);
+  }
+
+  // Focus the camera on the point of the animated mesh under the cursor.
+  //
+  void look_at(float x, float y) {
+    const auto r = primary_ray(camera, x, y);
+    if (const auto p = intersection(r, mesh, mesh_bvh)) {
+      origin = r(p.t);
+      radius = p.t;
+      view_should_update = true;
+    }
+  }
+
   // polyhedral_surface surface{};
   scene surface{};
   // flat_scene surface{};
   float bounding_radius;
 
   skinned_mesh mesh{};
+  skinned_mesh_bvh mesh_bvh{};
 
   std::chrono::time_point<std::chrono::high_resolution_clock> start =
       std::chrono::high_resolution_clock::now();
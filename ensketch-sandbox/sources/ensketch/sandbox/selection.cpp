@@ -0,0 +1,309 @@
+#include <ensketch/sandbox/selection.hpp>
+//
+#include <ensketch/sandbox/parallel.hpp>
+#include <ensketch/sandbox/ray_tracer.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+enum class coverage { outside, partial, inside };
+
+// Check whether the segment from `a` to `b` touches the box.
+// Touching counts as crossing to keep the classification conservative.
+//
+bool crosses(const vec2& a, const vec2& b, const aabb2& box) noexcept {
+  if ((std::max(a.x, b.x) < box._min.x) || (std::min(a.x, b.x) > box._max.x) ||
+      (std::max(a.y, b.y) < box._min.y) || (std::min(a.y, b.y) > box._max.y))
+    return false;
+  const auto e = b - a;
+  const auto side = [&](float x, float y) {
+    return e.x * (y - a.y) - e.y * (x - a.x);
+  };
+  const array<float, 4> s{side(box._min.x, box._min.y),
+                          side(box._max.x, box._min.y),
+                          side(box._min.x, box._max.y),
+                          side(box._max.x, box._max.y)};
+  return !(std::ranges::all_of(s, [](float x) { return x > 0.0f; }) ||
+           std::ranges::all_of(s, [](float x) { return x < 0.0f; }));
+}
+
+auto classify(const aabb2& box, const screen_region& region) noexcept
+    -> coverage {
+  const auto& r = region.bounds;
+  if ((box._max.x < r._min.x) || (box._min.x > r._max.x) ||
+      (box._max.y < r._min.y) || (box._min.y > r._max.y))
+    return coverage::outside;
+
+  if (region.lasso.empty()) {
+    return ((r._min.x <= box._min.x) && (box._max.x <= r._max.x) &&
+            (r._min.y <= box._min.y) && (box._max.y <= r._max.y))
+               ? coverage::inside
+               : coverage::partial;
+  }
+
+  // If no edge of the lasso touches the box, the whole box
+  // lies on the same side and its center decides for all points.
+  //
+  const auto& lasso = region.lasso;
+  for (size_t i = 0, j = lasso.size() - 1; i < lasso.size(); j = i++)
+    if (crosses(lasso[j], lasso[i], box)) return coverage::partial;
+  return region.contains(box.origin()) ? coverage::inside : coverage::outside;
+}
+
+// The projection of a box in front of the camera is contained in the
+// bounding rectangle of its projected corners. Boxes that reach behind
+// the camera have no such bound and are only culled if they lie
+// completely behind it.
+//
+auto classify(const opengl::camera& camera,
+              const aabb3& box,
+              const screen_region& region) noexcept -> coverage {
+  optional<aabb2> bounds{};
+  int behind = 0;
+  for (int k = 0; k < 8; ++k) {
+    const vec3 p{(k & 1) ? box._max.x : box._min.x,
+                 (k & 2) ? box._max.y : box._min.y,
+                 (k & 4) ? box._max.z : box._min.z};
+    const auto q = screen_position(camera, p);
+    if (!q) {
+      ++behind;
+      continue;
+    }
+    bounds = bounds ? aabb2{*bounds, *q} : aabb2{*q};
+  }
+  if (behind == 8) return coverage::outside;
+  if (behind > 0) return coverage::partial;
+  return classify(*bounds, region);
+}
+
+// Consecutive range of elements in tree order. Elements of ranges
+// that lie completely inside the region need no further test.
+//
+struct element_range {
+  uint32 first;
+  uint32 last;
+  bool inside;
+};
+
+// Return the range of elements in tree order that belongs to the subtree
+// of the given node. It is given by its leftmost and rightmost leaves.
+//
+auto range_of(const auto& tree, uint32 index) noexcept -> pair<uint32, uint32> {
+  auto first = index;
+  while (!tree.nodes[first].is_leaf()) first = tree.nodes[first].offset;
+  auto last = index;
+  while (!tree.nodes[last].is_leaf()) last = tree.nodes[last].offset + 1;
+  return {tree.nodes[first].offset,
+          tree.nodes[last].offset + tree.nodes[last].count};
+}
+
+// Traverse the tree and gather the ranges of all nodes that are
+// inside the region and of all leaves that are partially covered.
+// The traversal is cheap compared to the tests of the elements.
+// So, it is done by a single thread.
+//
+template <typename tree_type>
+auto ranges_from(const opengl::camera& camera,
+                 const tree_type& tree,
+                 const screen_region& region) -> vector<element_range> {
+  vector<element_range> result{};
+  if (tree.empty()) return result;
+  array<uint32, tree_type::max_depth> stack;
+  size_t size = 0;
+  stack[size++] = 0;
+  while (size > 0) {
+    const auto index = stack[--size];
+    const auto& node = tree.nodes[index];
+    const auto c = classify(camera, node.box, region);
+    if (c == coverage::outside) continue;
+    if (c == coverage::inside) {
+      const auto [first, last] = range_of(tree, index);
+      result.push_back({first, last, true});
+      continue;
+    }
+    if (node.is_leaf()) {
+      result.push_back({node.offset, node.offset + node.count, false});
+      continue;
+    }
+    stack[size++] = node.offset + 1;
+    stack[size++] = node.offset;
+  }
+  return result;
+}
+
+// Select the elements of all gathered ranges in parallel. The element at
+// position `i` in tree order is given by its ID `id(i)` and the point
+// `position(i)` that is tested against the region. Selected elements
+// additionally need to pass `accept(id, point)`, like a visibility test.
+//
+template <typename tree_type>
+auto select(const opengl::camera& camera,
+            const tree_type& tree,
+            const screen_region& region,
+            size_t size,
+            auto&& id,
+            auto&& position,
+            auto&& accept) -> selection_mask {
+  selection_mask result(size);
+  const auto ranges = ranges_from(camera, tree, region);
+  // Ranges of inner nodes may be much larger than leaves.
+  // Hence, they are handed out dynamically.
+  parallel_for_dynamic(ranges.size(), [&](size_t k) {
+    const auto& range = ranges[k];
+    for (auto i = range.first; i < range.last; ++i) {
+      const auto p = position(i);
+      if (!range.inside) {
+        const auto q = screen_position(camera, p);
+        if (!q || !region.contains(*q)) continue;
+      }
+      const auto x = id(i);
+      if (accept(x, p)) result.set(x);
+    }
+  });
+  return result;
+}
+
+// Check whether the point is not occluded by the surface. The first hit may
+// be on the primitive the point belongs to which is checked by `owns(f)`.
+// Otherwise, the hit must not be in front of the point up to rounding errors.
+//
+bool visible(const opengl::camera& camera,
+             const polyhedral_surface& surface,
+             const bvh& tree,
+             const vec3& p,
+             auto&& owns) noexcept {
+  const auto d = p - camera.position();
+  const auto l = length(d);
+  if (l == 0.0f) return true;
+  const auto hit = intersection(ray{camera.position(), d / l}, surface, tree);
+  return !hit || owns(hit.f) || (hit.t >= l * (1.0f - 1e-4f));
+}
+
+auto select_vertices(const opengl::camera& camera,
+                     const polyhedral_surface& surface,
+                     const kd_tree& tree,
+                     const screen_region& region,
+                     auto&& accept) -> selection_mask {
+  return select(
+      camera, tree, region, surface.vertices.size(),
+      [&](uint32 i) { return tree.indices[i]; },
+      [&](uint32 i) { return tree.points[i]; }, accept);
+}
+
+auto centroid(const polyhedral_surface& surface,
+              polyhedral_surface::face_id f) noexcept -> vec3 {
+  const auto& face = surface.faces[f];
+  return (surface.vertices[face[0]].position +
+          surface.vertices[face[1]].position +
+          surface.vertices[face[2]].position) /
+         3.0f;
+}
+
+auto select_faces(const opengl::camera& camera,
+                  const polyhedral_surface& surface,
+                  const bvh& tree,
+                  const screen_region& region,
+                  auto&& accept) -> selection_mask {
+  return select(
+      camera, tree, region, surface.faces.size(),
+      [&](uint32 i) { return tree.primitives[i]; },
+      [&](uint32 i) { return centroid(surface, tree.primitives[i]); }, accept);
+}
+
+}  // namespace
+
+auto selection_mask::count() const noexcept -> size_t {
+  size_t result = 0;
+  for (auto w : words) result += std::popcount(w);
+  return result;
+}
+
+auto selection_mask::indices() const -> vector<uint32> {
+  vector<uint32> result{};
+  result.reserve(count());
+  for (size_t k = 0; k < words.size(); ++k) {
+    for (auto w = words[k]; w; w &= w - 1)
+      result.push_back(k * word_bits + std::countr_zero(w));
+  }
+  return result;
+}
+
+bool screen_region::contains(const vec2& p) const noexcept {
+  if ((p.x < bounds._min.x) || (p.x > bounds._max.x) ||
+      (p.y < bounds._min.y) || (p.y > bounds._max.y))
+    return false;
+  if (lasso.empty()) return true;
+
+  // Even-odd rule by counting the crossings of a horizontal ray.
+  //
+  bool result = false;
+  for (size_t i = 0, j = lasso.size() - 1; i < lasso.size(); j = i++) {
+    const auto& a = lasso[i];
+    const auto& b = lasso[j];
+    if (((a.y > p.y) != (b.y > p.y)) &&
+        (p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x))
+      result = !result;
+  }
+  return result;
+}
+
+auto screen_region_from(const vec2& p, const vec2& q) -> screen_region {
+  return {aabb2{p, q}};
+}
+
+auto screen_region_from(std::span<const vec2> lasso) -> screen_region {
+  // Start with empty bounds such that lassos
+  // without interior do not contain anything.
+  //
+  screen_region result{};
+  result.bounds._min = vec2{infinity};
+  result.bounds._max = vec2{-infinity};
+  result.lasso.assign(lasso.begin(), lasso.end());
+  if (lasso.size() < 3) return result;
+  for (const auto& p : lasso) result.bounds = aabb2{result.bounds, p};
+  return result;
+}
+
+auto select_vertices(const opengl::camera& camera,
+                     const polyhedral_surface& surface,
+                     const kd_tree& tree,
+                     const screen_region& region) -> selection_mask {
+  return select_vertices(camera, surface, tree, region,
+                         [](uint32, const vec3&) { return true; });
+}
+
+auto select_visible_vertices(const opengl::camera& camera,
+                             const polyhedral_surface& surface,
+                             const kd_tree& tree,
+                             const bvh& faces,
+                             const screen_region& region) -> selection_mask {
+  return select_vertices(
+      camera, surface, tree, region, [&](uint32 vid, const vec3& p) {
+        return visible(camera, surface, faces, p, [&](uint32 f) {
+          const auto& face = surface.faces[f];
+          return (face[0] == vid) || (face[1] == vid) || (face[2] == vid);
+        });
+      });
+}
+
+auto select_faces(const opengl::camera& camera,
+                  const polyhedral_surface& surface,
+                  const bvh& tree,
+                  const screen_region& region) -> selection_mask {
+  return select_faces(camera, surface, tree, region,
+                      [](uint32, const vec3&) { return true; });
+}
+
+auto select_visible_faces(const opengl::camera& camera,
+                          const polyhedral_surface& surface,
+                          const bvh& tree,
+                          const screen_region& region) -> selection_mask {
+  return select_faces(camera, surface, tree, region,
+                      [&](uint32 fid, const vec3& p) {
+                        return visible(camera, surface, tree, p,
+                                       [fid](uint32 f) { return f == fid; });
+                      });
+}
+
+}  // namespace ensketch::sandbox
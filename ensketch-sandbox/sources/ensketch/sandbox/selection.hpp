@@ -0,0 +1,115 @@
+#pragma once
+#include <ensketch/sandbox/aabb.hpp>
+#include <ensketch/sandbox/bvh.hpp>
+#include <ensketch/sandbox/kd_tree.hpp>
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+//
+#include <ensketch/opengl/camera.hpp>
+
+namespace ensketch::sandbox {
+
+/// Set of selected elements, like vertices or faces, stored as one bit per
+/// element in 32-bit words. Bit `i % 32` of word `i / 32` is set if and only
+/// if element `i` is selected. This is also the layout expected by shaders.
+/// So, the words can be uploaded as a GPU buffer in a single transfer.
+///
+struct selection_mask {
+  static constexpr size_t word_bits = 32;
+
+  selection_mask() = default;
+  explicit selection_mask(size_t n)
+      : _size{n}, words((n + word_bits - 1) / word_bits, 0) {}
+
+  auto size() const noexcept -> size_t { return _size; }
+
+  bool operator[](size_t i) const noexcept {
+    return (words[i / word_bits] >> (i % word_bits)) & 1u;
+  }
+
+  /// Select the given element. This is thread-safe
+  /// such that masks may be filled in parallel.
+  ///
+  void set(size_t i) noexcept {
+    std::atomic_ref<uint32>{words[i / word_bits]}.fetch_or(
+        uint32{1} << (i % word_bits), std::memory_order_relaxed);
+  }
+
+  /// Return the number of selected elements.
+  ///
+  auto count() const noexcept -> size_t;
+
+  /// Return the indices of all selected elements in ascending order.
+  ///
+  auto indices() const -> vector<uint32>;
+
+  size_t _size{};
+  vector<uint32> words{};
+};
+
+/// Region on the screen given in the pixel coordinates of the camera.
+/// It is either a rectangle or a lasso, i.e. a closed polygon whose
+/// last point is implicitly connected to its first point. The interior
+/// of self-intersecting lassos is given by the even-odd rule.
+///
+struct screen_region {
+  /// Check whether the point on the screen lies inside the region.
+  ///
+  bool contains(const vec2& p) const noexcept;
+
+  aabb2 bounds{};
+  // Empty for rectangles which are then given by their bounds.
+  vector<vec2> lasso{};
+};
+
+/// Constructor Extension for Screen Region
+/// Return the rectangle given by the bounding box of two screen points.
+///
+auto screen_region_from(const vec2& p, const vec2& q) -> screen_region;
+
+/// Constructor Extension for Screen Region
+/// Return the lasso given by the polygon of recorded screen points,
+/// like the mouse curve of the viewer. Lassos with less
+/// than three points do not contain anything.
+///
+auto screen_region_from(std::span<const vec2> lasso) -> screen_region;
+
+/// Return all vertices of the surface whose screen positions lie inside
+/// the region. Instead of projecting every vertex, the kd-tree is traversed
+/// and the projected bounding boxes of its nodes are classified against the
+/// region. Nodes outside are culled and the vertices of nodes completely
+/// inside are selected without further tests. Only the remaining leaves
+/// test their vertices one by one. The tree must have been built over
+/// the vertices of the surface.
+///
+auto select_vertices(const opengl::camera& camera,
+                     const polyhedral_surface& surface,
+                     const kd_tree& tree,
+                     const screen_region& region) -> selection_mask;
+
+/// Like `select_vertices` but only selects vertices that are visible from the
+/// camera, i.e. not occluded by the surface itself. For every vertex passing
+/// the region test, a ray is cast towards it by traversing the BVH.
+///
+auto select_visible_vertices(const opengl::camera& camera,
+                             const polyhedral_surface& surface,
+                             const kd_tree& tree,
+                             const bvh& faces,
+                             const screen_region& region) -> selection_mask;
+
+/// Return all faces of the surface whose centroids lie inside the region on
+/// the screen. The BVH over the faces is traversed in the same way as the
+/// kd-tree for vertices.
+///
+auto select_faces(const opengl::camera& camera,
+                  const polyhedral_surface& surface,
+                  const bvh& tree,
+                  const screen_region& region) -> selection_mask;
+
+/// Like `select_faces` but only selects faces whose centroids are visible.
+///
+auto select_visible_faces(const opengl::camera& camera,
+                          const polyhedral_surface& surface,
+                          const bvh& tree,
+                          const screen_region& region) -> selection_mask;
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,286 @@
+#pragma once
+#include <ensketch/sandbox/defaults.hpp>
+//
+#if defined(__AVX__)
+#include <immintrin.h>
+#define ENSKETCH_SANDBOX_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define ENSKETCH_SANDBOX_SIMD_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ENSKETCH_SANDBOX_SIMD_NEON
+#endif
+
+/// Minimal abstraction of packed single-precision floating-point numbers.
+/// The instruction set is chosen at compile time. AVX provides eight lanes
+/// whereas SSE2 and NEON provide four lanes. Without any of them, a scalar
+/// emulation with four lanes is used that compilers may still vectorize.
+/// Comparisons return packs whose lanes are either all zero or all one bits.
+/// Such masks are combined by `&` and converted to a bit mask by `mask_of`.
+///
+namespace ensketch::sandbox::simd {
+
+#if defined(ENSKETCH_SANDBOX_SIMD_AVX)
+
+inline constexpr size_t width = 8;
+inline constexpr xstd::czstring instruction_set = "AVX";
+
+struct float_pack {
+  __m256 data;
+};
+
+inline auto load(const float32* p) noexcept -> float_pack {
+  return {_mm256_loadu_ps(p)};
+}
+inline void store(float32* p, float_pack x) noexcept {
+  _mm256_storeu_ps(p, x.data);
+}
+inline auto broadcast(float32 x) noexcept -> float_pack {
+  return {_mm256_set1_ps(x)};
+}
+
+inline auto operator+(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_add_ps(x.data, y.data)};
+}
+inline auto operator-(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_sub_ps(x.data, y.data)};
+}
+inline auto operator*(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_mul_ps(x.data, y.data)};
+}
+inline auto operator/(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_div_ps(x.data, y.data)};
+}
+inline auto operator&(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_and_ps(x.data, y.data)};
+}
+inline auto operator<=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_cmp_ps(x.data, y.data, _CMP_LE_OQ)};
+}
+inline auto operator>=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_cmp_ps(x.data, y.data, _CMP_GE_OQ)};
+}
+inline auto operator>(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_cmp_ps(x.data, y.data, _CMP_GT_OQ)};
+}
+inline auto operator!=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm256_cmp_ps(x.data, y.data, _CMP_NEQ_OQ)};
+}
+inline auto mask_of(float_pack x) noexcept -> uint32 {
+  return _mm256_movemask_ps(x.data);
+}
+
+#elif defined(ENSKETCH_SANDBOX_SIMD_SSE)
+
+inline constexpr size_t width = 4;
+inline constexpr xstd::czstring instruction_set = "SSE2";
+
+struct float_pack {
+  __m128 data;
+};
+
+inline auto load(const float32* p) noexcept -> float_pack {
+  return {_mm_loadu_ps(p)};
+}
+inline void store(float32* p, float_pack x) noexcept {
+  _mm_storeu_ps(p, x.data);
+}
+inline auto broadcast(float32 x) noexcept -> float_pack {
+  return {_mm_set1_ps(x)};
+}
+
+inline auto operator+(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_add_ps(x.data, y.data)};
+}
+inline auto operator-(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_sub_ps(x.data, y.data)};
+}
+inline auto operator*(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_mul_ps(x.data, y.data)};
+}
+inline auto operator/(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_div_ps(x.data, y.data)};
+}
+inline auto operator&(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_and_ps(x.data, y.data)};
+}
+inline auto operator<=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_cmple_ps(x.data, y.data)};
+}
+inline auto operator>=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_cmpge_ps(x.data, y.data)};
+}
+inline auto operator>(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_cmpgt_ps(x.data, y.data)};
+}
+inline auto operator!=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {_mm_cmpneq_ps(x.data, y.data)};
+}
+inline auto mask_of(float_pack x) noexcept -> uint32 {
+  return _mm_movemask_ps(x.data);
+}
+
+#elif defined(ENSKETCH_SANDBOX_SIMD_NEON)
+
+inline constexpr size_t width = 4;
+inline constexpr xstd::czstring instruction_set = "NEON";
+
+struct float_pack {
+  float32x4_t data;
+};
+
+inline auto load(const float32* p) noexcept -> float_pack {
+  return {vld1q_f32(p)};
+}
+inline void store(float32* p, float_pack x) noexcept {
+  vst1q_f32(p, x.data);
+}
+inline auto broadcast(float32 x) noexcept -> float_pack {
+  return {vdupq_n_f32(x)};
+}
+
+inline auto operator+(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vaddq_f32(x.data, y.data)};
+}
+inline auto operator-(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vsubq_f32(x.data, y.data)};
+}
+inline auto operator*(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vmulq_f32(x.data, y.data)};
+}
+inline auto operator/(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vdivq_f32(x.data, y.data)};
+}
+inline auto operator&(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(x.data),
+                                          vreinterpretq_u32_f32(y.data)))};
+}
+inline auto operator<=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vreinterpretq_f32_u32(vcleq_f32(x.data, y.data))};
+}
+inline auto operator>=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vreinterpretq_f32_u32(vcgeq_f32(x.data, y.data))};
+}
+inline auto operator>(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vreinterpretq_f32_u32(vcgtq_f32(x.data, y.data))};
+}
+inline auto operator!=(float_pack x, float_pack y) noexcept -> float_pack {
+  return {vreinterpretq_f32_u32(vmvnq_u32(vceqq_f32(x.data, y.data)))};
+}
+inline auto mask_of(float_pack x) noexcept -> uint32 {
+  const uint32x4_t bits{1, 2, 4, 8};
+  return vaddvq_u32(vandq_u32(vreinterpretq_u32_f32(x.data), bits));
+}
+
+#else
+
+inline constexpr size_t width = 4;
+inline constexpr xstd::czstring instruction_set = "scalar";
+
+struct float_pack {
+  std::array<float32, width> data;
+};
+
+namespace detail {
+// Lane-wise application of a binary function.
+//
+inline auto apply(float_pack x, float_pack y, auto&& f) noexcept
+    -> float_pack {
+  float_pack result;
+  for (size_t i = 0; i < width; ++i) result.data[i] = f(x.data[i], y.data[i]);
+  return result;
+}
+// Mask lane with all bits set or cleared.
+//
+inline auto lane(bool x) noexcept -> float32 {
+  return std::bit_cast<float32>(x ? ~uint32{0} : uint32{0});
+}
+}  // namespace detail
+
+inline auto load(const float32* p) noexcept -> float_pack {
+  float_pack result;
+  std::copy_n(p, width, result.data.begin());
+  return result;
+}
+inline void store(float32* p, float_pack x) noexcept {
+  std::ranges::copy(x.data, p);
+}
+inline auto broadcast(float32 x) noexcept -> float_pack {
+  float_pack result;
+  result.data.fill(x);
+  return result;
+}
+
+inline auto operator+(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(x, y, [](float32 a, float32 b) { return a + b; });
+}
+inline auto operator-(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(x, y, [](float32 a, float32 b) { return a - b; });
+}
+inline auto operator*(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(x, y, [](float32 a, float32 b) { return a * b; });
+}
+inline auto operator/(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(x, y, [](float32 a, float32 b) { return a / b; });
+}
+inline auto operator&(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(x, y, [](float32 a, float32 b) {
+    return std::bit_cast<float32>(std::bit_cast<uint32>(a) &
+                                  std::bit_cast<uint32>(b));
+  });
+}
+inline auto operator<=(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(
+      x, y, [](float32 a, float32 b) { return detail::lane(a <= b); });
+}
+inline auto operator>=(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(
+      x, y, [](float32 a, float32 b) { return detail::lane(a >= b); });
+}
+inline auto operator>(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(
+      x, y, [](float32 a, float32 b) { return detail::lane(a > b); });
+}
+inline auto operator!=(float_pack x, float_pack y) noexcept -> float_pack {
+  return detail::apply(
+      x, y, [](float32 a, float32 b) { return detail::lane(a != b); });
+}
+inline auto mask_of(float_pack x) noexcept -> uint32 {
+  uint32 result = 0;
+  for (size_t i = 0; i < width; ++i)
+    result |= (std::bit_cast<uint32>(x.data[i]) >> 31) << i;
+  return result;
+}
+
+#endif
+
+/// Three-dimensional vector of packs to describe `width` points at once.
+///
+struct vec3_pack {
+  float_pack x, y, z;
+};
+
+inline auto operator-(const vec3_pack& a, const vec3_pack& b) noexcept
+    -> vec3_pack {
+  return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+inline auto dot(const vec3_pack& a, const vec3_pack& b) noexcept
+    -> float_pack {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline auto cross(const vec3_pack& a, const vec3_pack& b) noexcept
+    -> vec3_pack {
+  return {a.y * b.z - a.z * b.y,  //
+          a.z * b.x - a.x * b.z,  //
+          a.x * b.y - a.y * b.x};
+}
+
+inline auto broadcast(const glm::vec3& v) noexcept -> vec3_pack {
+  return {broadcast(v.x), broadcast(v.y), broadcast(v.z)};
+}
+
+}  // namespace ensketch::sandbox::simd
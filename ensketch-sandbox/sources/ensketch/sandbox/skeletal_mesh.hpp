@@ -2,6 +2,7 @@
 #include <ensketch/opengl/opengl.hpp>
 #include <ensketch/sandbox/aabb.hpp>
 #include <ensketch/sandbox/defaults.hpp>
+#include <ensketch/sandbox/scene.hpp>
 
 namespace ensketch::sandbox {
 
@@ -45,6 +46,12 @@ struct skeletal_mesh {
 ///
 auto aabb_from(const skeletal_mesh& mesh) noexcept -> aabb3;
 
+/// Extract the first mesh of an imported scene with its bone weights.
+///
+auto skeletal_mesh_from(const scene& in) -> skeletal_mesh;
+
+/// Import the given file as scene and extract its first mesh.
+///
 auto skeletal_mesh_from_file(const std::filesystem::path& path)
     -> skeletal_mesh;
 
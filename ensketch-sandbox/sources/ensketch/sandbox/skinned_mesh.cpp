@@ -1,4 +1,5 @@
 #include <ensketch/sandbox/log.hpp>
+#include <ensketch/sandbox/parallel.hpp>
 #include <ensketch/sandbox/skinned_mesh.hpp>
 
 namespace ensketch::sandbox {
@@ -179,4 +180,20 @@ auto skinned_mesh_from(const scene& in) -> skinned_mesh {
   return out;
 }
 
+void load_skinned_positions(const skinned_mesh& mesh,
+                            std::span<const glm::mat4> transforms,
+                            std::span<glm::vec3> out) {
+  assert(transforms.size() == mesh.bones.size());
+  assert(out.size() == mesh.vertices.size());
+  const auto& offsets = mesh.weights.offsets;
+  const auto& entries = mesh.weights.entries;
+  parallel_for(mesh.vertices.size(), [&](size_t vid) {
+    glm::mat4 transform{0.0f};
+    for (auto i = offsets[vid]; i < offsets[vid + 1]; ++i)
+      transform += entries[i].weight * transforms[entries[i].index];
+    const auto& p = mesh.vertices[vid].position;
+    out[vid] = glm::vec3(transform * glm::vec4(p, 1.0f));
+  });
+}
+
 }  // namespace ensketch::sandbox
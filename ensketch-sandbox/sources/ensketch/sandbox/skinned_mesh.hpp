@@ -119,4 +119,23 @@ inline auto animation_transforms(const skinned_mesh& mesh,
   return result;
 }
 
+/// Transform all vertex positions of the mesh on the CPU by linear blend
+/// skinning with the given bone transforms in the same way as the vertex
+/// shader of the scene viewer does on the GPU. The transforms are expected
+/// to be computed by `load_global_transforms` or `load_animation_transforms`.
+/// Vertices are processed in parallel.
+///
+void load_skinned_positions(const skinned_mesh& mesh,
+                            std::span<const glm::mat4> transforms,
+                            std::span<glm::vec3> out);
+
+inline auto skinned_positions(const skinned_mesh& mesh,
+                              std::span<const glm::mat4> transforms)
+    -> std::vector<glm::vec3> {
+  std::vector<glm::vec3> result;
+  result.resize(mesh.vertices.size());
+  load_skinned_positions(mesh, transforms, result);
+  return result;
+}
+
 }  // namespace ensketch::sandbox
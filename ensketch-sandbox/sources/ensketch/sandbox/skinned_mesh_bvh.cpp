@@ -0,0 +1,43 @@
+#include <ensketch/sandbox/skinned_mesh_bvh.hpp>
+//
+#include <ensketch/sandbox/parallel.hpp>
+
+namespace ensketch::sandbox {
+
+void skinned_mesh_bvh::update(const skinned_mesh& mesh,
+                              std::span<const glm::mat4> transforms) {
+  vertices.resize(mesh.vertices.size());
+  load_skinned_positions(mesh, transforms, vertices);
+
+  boxes.resize(mesh.faces.size());
+  parallel_for(mesh.faces.size(), [&](size_t i) {
+    const auto& f = mesh.faces[i];
+    boxes[i] = aabb3{aabb3{vertices[f[0]], vertices[f[1]]}, vertices[f[2]]};
+  });
+
+  // A finished rebuild only differs in its bounding boxes
+  // from the current pose. So, it is refitted like the old tree.
+  //
+  if (rebuild.valid() &&
+      (rebuild.wait_for(std::chrono::seconds{0}) == std::future_status::ready))
+    hierarchy = rebuild.get();
+
+  if (hierarchy.primitives.size() != boxes.size()) {
+    // Results of a rebuild for another mesh are discarded.
+    if (rebuild.valid()) rebuild.get();
+    hierarchy = bvh_from(boxes);
+    updates = 0;
+    return;
+  }
+
+  refit(hierarchy, boxes);
+  ++updates;
+  if ((rebuild_interval == 0) || (updates < rebuild_interval) ||
+      rebuild.valid())
+    return;
+  rebuild = std::async(std::launch::async,
+                       [boxes = boxes] { return bvh_from(boxes); });
+  updates = 0;
+}
+
+}  // namespace ensketch::sandbox
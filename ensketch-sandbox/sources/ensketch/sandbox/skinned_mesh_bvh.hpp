@@ -0,0 +1,60 @@
+#pragma once
+#include <ensketch/sandbox/bvh.hpp>
+#include <ensketch/sandbox/ray_tracer.hpp>
+#include <ensketch/sandbox/skinned_mesh.hpp>
+
+namespace ensketch::sandbox {
+
+/// BVH over the faces of a skinned mesh that follows its animated pose.
+/// Every update skins all vertices on the CPU and refits the tree in linear
+/// time. Refitting keeps the structure of the tree that has been built for
+/// an earlier pose. To bound the loss of quality, a new tree is built for
+/// the current pose in the background after a fixed number of updates.
+/// It replaces the old one during the first update after it is finished.
+/// So, updates never wait for a rebuild.
+///
+class skinned_mesh_bvh {
+ public:
+  /// Number of updates after which a rebuild is started.
+  /// A value of zero disables rebuilds.
+  ///
+  size_t rebuild_interval = 64;
+
+  /// Skin the mesh with the given bone transforms and refit the tree.
+  /// The tree is built synchronously for the first update
+  /// and whenever the number of faces has changed.
+  ///
+  void update(const skinned_mesh& mesh, std::span<const glm::mat4> transforms);
+
+  /// Skinned vertex positions of the last update.
+  ///
+  auto positions() const noexcept -> std::span<const glm::vec3> {
+    return vertices;
+  }
+
+  auto tree() const noexcept -> const bvh& { return hierarchy; }
+
+  /// Check whether a rebuild is currently running in the background.
+  ///
+  bool rebuilding() const noexcept { return rebuild.valid(); }
+
+ private:
+  vector<glm::vec3> vertices{};
+  vector<aabb3> boxes{};
+  bvh hierarchy{};
+  size_t updates = 0;
+  std::future<bvh> rebuild{};
+};
+
+/// Find the closest intersection of a ray with a skinned mesh in the pose
+/// of the last update of the given BVH. The indices of the result refer
+/// to the faces of the mesh.
+///
+inline auto intersection(const ray& r,
+                         const skinned_mesh& mesh,
+                         const skinned_mesh_bvh& tree) noexcept
+    -> ray_polyhedral_surface_intersection {
+  return intersection(r, tree.positions(), mesh.faces, tree.tree());
+}
+
+}  // namespace ensketch::sandbox
@@ -0,0 +1,147 @@
+#pragma once
+#include <ensketch/sandbox/stl_surface.hpp>
+
+namespace ensketch::sandbox::detail {
+
+constexpr bool is_space(char c) noexcept {
+  return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t') ||
+         (c == '\v') || (c == '\f');
+}
+
+// Minimal tokenizer for ASCII-based STL files that operates on a character
+// range of a memory-mapped file or a buffer. Keywords are compared in-place
+// and numbers are parsed by 'from_chars' without any locale or stream
+// overhead. It is shared by the loader of 'stl_surface' and the streaming
+// reader which only keeps a window of the file in memory.
+//
+struct ascii_facet_parser {
+  using triangle = stl_surface::triangle;
+  using parser_error = stl_surface::parser_error;
+
+  const char* it;
+  const char* last;
+  // Needed to report byte offsets and line numbers in error messages.
+  const char* origin;
+  // Line number of 'origin' inside the whole file.
+  size_t line = 1;
+
+  void skip_space() noexcept {
+    while ((it != last) && is_space(*it)) ++it;
+  }
+
+  void skip_line() noexcept {
+    while ((it != last) && (*it != '\n')) ++it;
+  }
+
+  auto token() noexcept -> string_view {
+    skip_space();
+    const auto first = it;
+    while ((it != last) && !is_space(*it)) ++it;
+    return {first, size_t(it - first)};
+  }
+
+  [[noreturn]] void throw_error(string_view message) const {
+    const auto current = line + std::count(origin, it, '\n');
+    throw parser_error(format(
+        "Failed to parse ASCII-based STL file in line {}. {}", current,
+        message));
+  }
+
+  void match(string_view keyword) {
+    if (token() == keyword) return;
+    throw_error(format("Failed to match keyword '{}'.", keyword));
+  }
+
+  auto number() -> float32 {
+    skip_space();
+    // 'from_chars' does not accept an explicit plus sign.
+    if ((it != last) && (*it == '+')) ++it;
+    float32 result;
+    const auto [ptr, error] = from_chars(it, last, result);
+    if (error != errc{}) throw_error("Failed to parse floating-point number.");
+    it = ptr;
+    return result;
+  }
+
+  auto point() -> vec3 {
+    vec3 result;
+    result.x = number();
+    result.y = number();
+    result.z = number();
+    return result;
+  }
+
+  // Parse the next facet into 't' and return whether there was one.
+  // 'solid' and 'endsolid' lines may appear in between facets.
+  // So, files that contain more than one solid are supported as well.
+  //
+  bool next(triangle& t) {
+    while (true) {
+      const auto keyword = token();
+      if (keyword.empty()) return false;
+      if (keyword == "facet") {
+        match("normal");
+        t.normal = point();
+        match("outer");
+        match("loop");
+        for (int i = 0; i < 3; ++i) {
+          match("vertex");
+          t.vertex[i] = point();
+        }
+        match("endloop");
+        match("endfacet");
+        return true;
+      } else if ((keyword == "endsolid") || (keyword == "solid")) {
+        // The rest of the line only contains the optional name of the solid.
+        skip_line();
+      } else
+        throw_error("Failed to match keyword 'facet' or 'endsolid'.");
+    }
+  }
+
+  // Parse all facets up to 'last' and append them to 'triangles'.
+  //
+  void parse(std::vector<triangle>& triangles) {
+    triangle t{};
+    while (next(t)) triangles.push_back(t);
+  }
+};
+
+// Return the first position in '[first, last)' that starts a facet, i.e. the
+// keyword 'facet' followed by 'normal' and preceded by whitespace.
+// The preceding whitespace rules out matches inside of 'endfacet'.
+// If there is no such position, 'last' is returned.
+//
+inline auto next_facet(const char* first, const char* last) noexcept
+    -> const char* {
+  constexpr string_view keyword = "facet";
+  for (auto it = first; it != last; ++it) {
+    it = std::search(it, last, keyword.begin(), keyword.end());
+    if (it == last) return last;
+    if ((it == first) || !is_space(it[-1])) continue;
+    auto next = it + keyword.size();
+    if ((next == last) || !is_space(*next)) continue;
+    while ((next != last) && is_space(*next)) ++next;
+    if (string_view{next, size_t(last - next)}.starts_with("normal"))
+      return it;
+  }
+  return last;
+}
+
+// Return the position right after the last complete facet in '[first, last)',
+// i.e. after the last keyword 'endfacet' that is followed by whitespace.
+// If there is no such position, 'first' is returned.
+//
+inline auto end_of_last_facet(const char* first, const char* last) noexcept
+    -> const char* {
+  constexpr string_view keyword = "endfacet";
+  const string_view text{first, size_t(last - first)};
+  for (auto i = text.rfind(keyword); i != string_view::npos;
+       i = (i == 0) ? string_view::npos : text.rfind(keyword, i - 1)) {
+    const auto end = i + keyword.size();
+    if ((end < text.size()) && is_space(text[end])) return first + end;
+  }
+  return first;
+}
+
+}  // namespace ensketch::sandbox::detail
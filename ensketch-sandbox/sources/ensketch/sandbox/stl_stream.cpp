@@ -0,0 +1,318 @@
+#include <ensketch/sandbox/stl_stream.hpp>
+//
+#include <ensketch/sandbox/stl_ascii_parser.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+using triangle = stl_surface::triangle;
+
+// Bounded queue of recycled triangle buffers between one producer and
+// several consumers. The producer acquires free buffers and submits them
+// when they are filled. Consumers pop filled buffers and release them after
+// processing. No buffer is ever allocated after construction. A stopped
+// pipeline immediately wakes up and ends all waiting threads.
+//
+class batch_pipeline {
+ public:
+  using batch_type = pair<size_t, size_t>;  // buffer index and first triangle
+
+  batch_pipeline(size_t buffer_count, size_t batch_size)
+      : buffers(buffer_count) {
+    for (size_t i = 0; i < buffer_count; ++i) {
+      buffers[i].reserve(batch_size);
+      free.push_back(i);
+    }
+  }
+
+  auto buffer(size_t i) noexcept -> vector<triangle>& { return buffers[i]; }
+
+  // Block until a buffer is free and return its index.
+  // Return nothing if the pipeline has been stopped.
+  //
+  auto acquire() -> optional<size_t> {
+    unique_lock lock{mutex};
+    free_signal.wait(lock, [this] { return stopped || !free.empty(); });
+    if (stopped) return nullopt;
+    const auto i = free.back();
+    free.pop_back();
+    buffers[i].clear();
+    return i;
+  }
+
+  void submit(size_t i, size_t first) {
+    {
+      lock_guard lock{mutex};
+      full.push_back({i, first});
+    }
+    full_signal.notify_one();
+  }
+
+  // Block until a filled buffer is available and return it.
+  // Return nothing if the pipeline has been stopped
+  // or closed and all batches have been processed.
+  //
+  auto pop() -> optional<batch_type> {
+    unique_lock lock{mutex};
+    full_signal.wait(lock,
+                     [this] { return stopped || closed || !full.empty(); });
+    if (stopped || full.empty()) return nullopt;
+    const auto result = full.front();
+    full.pop_front();
+    return result;
+  }
+
+  void release(size_t i) {
+    {
+      lock_guard lock{mutex};
+      free.push_back(i);
+    }
+    free_signal.notify_one();
+  }
+
+  // Signal that no further batches will be submitted.
+  //
+  void close() {
+    {
+      lock_guard lock{mutex};
+      closed = true;
+    }
+    full_signal.notify_all();
+  }
+
+  void stop() {
+    {
+      lock_guard lock{mutex};
+      stopped = true;
+    }
+    full_signal.notify_all();
+    free_signal.notify_all();
+  }
+
+ private:
+  vector<vector<triangle>> buffers{};
+  vector<size_t> free{};
+  deque<batch_type> full{};
+  std::mutex mutex{};
+  std::condition_variable free_signal{};
+  std::condition_variable full_signal{};
+  bool closed = false;
+  bool stopped = false;
+};
+
+// Producer-side helper that fills batches triangle by triangle
+// and submits them as soon as they are full.
+//
+struct batch_writer {
+  // Append `t` to the current batch.
+  // Return false if the pipeline has been stopped.
+  //
+  bool push(const triangle& t) {
+    if (!current) {
+      current = pipeline.acquire();
+      if (!current) return false;
+    }
+    auto& batch = pipeline.buffer(*current);
+    batch.push_back(t);
+    if (batch.size() == batch_size) flush();
+    return true;
+  }
+
+  void flush() {
+    if (!current) return;
+    const auto size = pipeline.buffer(*current).size();
+    pipeline.submit(*current, count);
+    count += size;
+    current.reset();
+  }
+
+  batch_pipeline& pipeline;
+  size_t batch_size;
+  optional<size_t> current{};
+  size_t count = 0;
+};
+
+void produce_binary(const filesystem::path& path,
+                    batch_writer& writer,
+                    size_t batch_size) {
+  constexpr size_t prefix_size =
+      sizeof(stl_surface::header) + sizeof(stl_surface::size_type);
+  constexpr size_t record_size =
+      sizeof(triangle) + sizeof(stl_surface::attribute_byte_count_type);
+
+  ifstream file{path, ios::binary};
+  if (!file)
+    throw runtime_error(
+        format("Failed to open STL file from path '{}'.", path.string()));
+
+  char prefix[prefix_size];
+  if (!file.read(prefix, prefix_size))
+    throw stl_surface::parser_error(
+        format("Failed to read binary STL file from path '{}'. The file is "
+               "smaller than the STL header.",
+               path.string()));
+  stl_surface::size_type size;
+  memcpy(&size, prefix + sizeof(stl_surface::header), sizeof(size));
+
+  const auto file_size = filesystem::file_size(path);
+  if (file_size < prefix_size + size_t(size) * record_size)
+    throw stl_surface::parser_error(format(
+        "Failed to read binary STL file from path '{}'. The file size of {} "
+        "bytes does not match the announced number of {} triangles.",
+        path.string(), file_size, size));
+
+  // Records are read in blocks of one batch
+  // and copied while skipping the attribute byte count.
+  vector<char> records(batch_size * record_size);
+  for (size_t i = 0; i < size;) {
+    const auto n = std::min<size_t>(batch_size, size - i);
+    if (!file.read(records.data(), n * record_size))
+      throw stl_surface::parser_error(
+          format("Failed to read binary STL file from path '{}'. Unexpected "
+                 "end of file.",
+                 path.string()));
+    for (size_t k = 0; k < n; ++k) {
+      triangle t;
+      memcpy(&t, records.data() + k * record_size, sizeof(triangle));
+      if (!writer.push(t)) return;
+    }
+    i += n;
+  }
+}
+
+void produce_ascii(const filesystem::path& path,
+                   batch_writer& writer,
+                   size_t block_size) {
+  ifstream file{path, ios::binary};
+  if (!file)
+    throw runtime_error(
+        format("Failed to open STL file from path '{}'.", path.string()));
+
+  // Only a window of the file is kept in memory. Every block is appended to
+  // the unparsed rest of the previous one. Only complete facets are parsed.
+  // The rest is shorter than one block unless a block does not contain a
+  // single complete facet which does not happen for reasonable block sizes.
+  // So, the window is reserved once with the size of two blocks.
+  string text{};
+  text.reserve(2 * block_size);
+  size_t line = 1;
+  bool header = true;
+  bool eof = false;
+  while (!eof) {
+    const auto size = text.size();
+    text.resize(size + block_size);
+    file.read(text.data() + size, block_size);
+    text.resize(size + file.gcount());
+    eof = !file;
+
+    const char* first = text.data();
+    const auto last = first + text.size();
+    detail::ascii_facet_parser parser{first, last, first, line};
+    if (header) {
+      // Wait for the whole first line.
+      if (!eof && (std::find(first, last, '\n') == last)) continue;
+      if (parser.token() != "solid")
+        parser.throw_error("Failed to match keyword 'solid' at the start.");
+      // The name of the solid is not used.
+      parser.skip_line();
+      header = false;
+    }
+
+    const auto end =
+        eof ? last : detail::end_of_last_facet(parser.it, last);
+    parser.last = end;
+    triangle t{};
+    while (parser.next(t))
+      if (!writer.push(t)) return;
+
+    line += std::count(first, parser.it, '\n');
+    text.erase(0, parser.it - first);
+  }
+}
+
+}  // namespace
+
+void stream_stl_file(const filesystem::path& path,
+                     const stl_batch_consumer& consumer,
+                     const stl_stream_options& options) {
+  const auto format = stl_surface::format_of(path);
+
+  // The producer needs one read buffer of roughly the size of one batch in
+  // binary form. For ASCII files, its window spans two such blocks.
+  // The rest of the budget is distributed over the batches.
+  const auto batch_size = std::max<size_t>(options.batch_size, 1);
+  const auto block_size =
+      batch_size *
+      (sizeof(triangle) + sizeof(stl_surface::attribute_byte_count_type));
+  const auto window_size =
+      ((format == stl_surface::file_format::ascii) ? 2 : 1) * block_size;
+  const auto batch_bytes = batch_size * sizeof(triangle);
+  const auto budget =
+      options.memory_budget - std::min(options.memory_budget, window_size);
+  const auto buffer_count = std::max<size_t>(2, budget / batch_bytes);
+  const auto consumer_count =
+      std::clamp<size_t>(options.consumer_count, 1, buffer_count);
+
+  batch_pipeline pipeline{buffer_count, batch_size};
+  exception_ptr producer_error{};
+  exception_ptr consumer_error{};
+  {
+    jthread producer{[&] {
+      try {
+        batch_writer writer{pipeline, batch_size};
+        if (format == stl_surface::file_format::ascii)
+          produce_ascii(path, writer, block_size);
+        else
+          produce_binary(path, writer, batch_size);
+        writer.flush();
+      } catch (...) {
+        producer_error = current_exception();
+        pipeline.stop();
+      }
+      pipeline.close();
+    }};
+
+    try {
+      parallel_chunks(consumer_count, consumer_count,
+                      [&](size_t, size_t, size_t) {
+                        try {
+                          while (const auto batch = pipeline.pop()) {
+                            const auto& [i, first] = *batch;
+                            consumer({pipeline.buffer(i), first});
+                            pipeline.release(i);
+                          }
+                        } catch (...) {
+                          // Also wakes up a waiting producer.
+                          pipeline.stop();
+                          throw;
+                        }
+                      });
+    } catch (...) {
+      consumer_error = current_exception();
+    }
+  }
+  if (consumer_error) rethrow_exception(consumer_error);
+  if (producer_error) rethrow_exception(producer_error);
+}
+
+auto aabb_from_stl_file(const filesystem::path& path,
+                        const stl_stream_options& options) -> aabb3 {
+  optional<aabb3> result{};
+  std::mutex mutex{};
+  stream_stl_file(
+      path,
+      [&](const stl_batch& batch) {
+        if (batch.triangles.empty()) return;
+        // Reduce every batch on its own to only lock once per batch.
+        aabb3 box{batch.triangles.front().vertex[0]};
+        for (const auto& t : batch.triangles)
+          for (const auto& v : t.vertex) box = aabb3{box, v};
+        lock_guard lock{mutex};
+        result = result ? aabb3{*result, box} : box;
+      },
+      options);
+  return result.value_or(aabb3{});
+}
+
+}  // namespace ensketch::sandbox
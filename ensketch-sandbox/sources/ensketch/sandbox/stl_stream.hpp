@@ -0,0 +1,61 @@
+#pragma once
+#include <ensketch/sandbox/aabb.hpp>
+#include <ensketch/sandbox/parallel.hpp>
+#include <ensketch/sandbox/stl_surface.hpp>
+
+namespace ensketch::sandbox {
+
+/// Options for streaming STL files in batches of triangles.
+///
+struct stl_stream_options {
+  /// Maximal number of triangles per batch.
+  /// Only the last batch of a file may be smaller.
+  size_t batch_size = size_t{1} << 16;
+
+  /// Upper bound in bytes for all buffers used by the stream.
+  /// This includes the read buffer of the file and all triangle batches
+  /// that are either filled, queued or processed by consumers.
+  /// The read buffer takes 50 bytes per triangle of a batch for binary
+  /// files and twice as much for ASCII-based files. At least two batches
+  /// are used, even if the budget is smaller.
+  size_t memory_budget = size_t{64} << 20;
+
+  /// Number of threads that process batches concurrently.
+  /// For a single consumer, batches are processed in file order.
+  size_t consumer_count = thread_count();
+};
+
+/// Batch of consecutive triangles of an STL file.
+/// `first` is the index of the first triangle of the batch inside the file.
+/// The triangle data is only valid during the invocation of the consumer.
+///
+struct stl_batch {
+  std::span<const stl_surface::triangle> triangles{};
+  size_t first{};
+};
+
+using stl_batch_consumer = std::function<void(const stl_batch&)>;
+
+/// Read the STL file given by `path` in batches of triangles without
+/// loading the whole file into memory and call `consumer` on every batch.
+/// Reading and parsing is done by a single producer thread while
+/// `options.consumer_count` threads concurrently invoke `consumer`.
+/// Batch buffers are recycled. So, the memory usage stays within the
+/// memory budget as long as it holds the read buffer and two batches.
+/// Smaller budgets are exceeded by that minimum. ASCII-based files may
+/// also exceed it if a single facet is longer than the read buffer.
+/// Both ASCII-based and binary files are supported.
+/// The first exception thrown by the parser or a consumer stops the stream
+/// and is re-thrown after all threads finished.
+///
+void stream_stl_file(const std::filesystem::path& path,
+                     const stl_batch_consumer& consumer,
+                     const stl_stream_options& options = {});
+
+/// Compute the bounding box of all vertices of a potentially huge STL file
+/// by streaming it through `stream_stl_file` with a parallel consumer stage.
+///
+auto aabb_from_stl_file(const std::filesystem::path& path,
+                        const stl_stream_options& options = {}) -> aabb3;
+
+}  // namespace ensketch::sandbox
@@ -1,4 +1,8 @@
 #include <ensketch/sandbox/stl_surface.hpp>
+//
+#include <ensketch/sandbox/memory_mapped_file.hpp>
+#include <ensketch/sandbox/parallel.hpp>
+#include <ensketch/sandbox/stl_ascii_parser.hpp>
 
 namespace ensketch::sandbox {
 
@@ -11,76 +15,130 @@ void stl_surface::load_from_binary_file(const filesystem::path& path) {
   static_assert(sizeof(triangle) == 48);
   static_assert(alignof(triangle) == 4);
 
-  fstream file{path, ios::in | ios::binary};
-  if (!file.is_open())
-    throw runtime_error(
-        format("Failed to open STL file from path '{}'.", path.string()));
+  // Map the whole file into memory. This lets us copy the triangle data
+  // straight out of the page cache instead of issuing two stream calls per
+  // triangle. 'memory_mapped_file' throws if the file cannot be opened.
+  const memory_mapped_file file{path};
 
-  // We will ignore the header.
-  // It has no specific use to us.
-  file.ignore(sizeof(header));
+  // The header is followed by the number of triangles
+  // and then by one fixed-size record for each triangle.
+  constexpr size_t prefix_size = sizeof(header) + sizeof(size_type);
+  constexpr size_t record_size =
+      sizeof(triangle) + sizeof(attribute_byte_count_type);
+  static_assert(record_size == 50);
+
+  if (file.size() < prefix_size)
+    throw parser_error(
+        format("Failed to read binary STL file from path '{}'. The file is "
+               "smaller than the STL header.",
+               path.string()));
 
   // Read number of triangles.
+  // We will ignore the header.
+  // It has no specific use to us.
   size_type size;
-  file.read((char*)&size, sizeof(size));
+  memcpy(&size, file.data() + sizeof(header), sizeof(size));
+
+  // Check the triangle count against the file size before allocating
+  // anything. Trailing bytes are tolerated as some exporters append them.
+  if (file.size() < prefix_size + size_t(size) * record_size)
+    throw parser_error(format(
+        "Failed to read binary STL file from path '{}'. The file size of {} "
+        "bytes does not match the announced number of {} triangles.",
+        path.string(), file.size(), size));
 
   triangles.resize(size);
 
   // Due to padding and alignment issues concerning 'float32' and 'uint16',
-  // we cannot read everything at once.
-  // Instead, we use a simple loop for every triangle.
-  for (auto& t : triangles) {
-    file.read((char*)&t, sizeof(triangle));
-    // Ignore the attribute byte count.
-    // There should not be any information anyway.
-    file.ignore(sizeof(attribute_byte_count_type));
+  // we cannot copy everything at once. Instead, every record is copied on
+  // its own while skipping the attribute byte count. There should not be
+  // any information in it anyway. The records are independent and, as such,
+  // are distributed over all threads in consecutive chunks.
+  const auto records = file.data() + prefix_size;
+  parallel_for_chunks(size, [&](size_t first, size_t last) {
+    for (auto i = first; i < last; ++i)
+      memcpy(&triangles[i], records + i * record_size, sizeof(triangle));
+  });
+}
+
+auto stl_surface::format_of(const filesystem::path& path) -> file_format {
+  ifstream file{path, ios::binary};
+  if (!file)
+    throw runtime_error(
+        format("Failed to open STL file from path '{}'.", path.string()));
+
+  char prefix[sizeof(header) + sizeof(size_type)]{};
+  file.read(prefix, sizeof(prefix));
+  string_view content{prefix, size_t(file.gcount())};
+
+  // ASCII files need to start with the keyword 'solid' and only
+  // contain printable characters. Many binary exporters write 'solid'
+  // into the header. But the header is often padded with zeros and the
+  // triangle count of typical files contains zero bytes as well.
+  const bool text = ranges::all_of(content, [](char c) {
+    return detail::is_space(c) || ((c >= 0x20) && (c < 0x7f));
+  });
+  while (!content.empty() && detail::is_space(content.front()))
+    content.remove_prefix(1);
+  const bool ascii = text && content.starts_with("solid");
+
+  // Binary files are identified by their size. Trailing bytes are
+  // tolerated as for the binary loader. A file of the exact size is
+  // binary, even if its prefix looks like text.
+  const auto file_size = filesystem::file_size(path);
+  if (size_t(file.gcount()) == sizeof(prefix)) {
+    size_type size;
+    memcpy(&size, prefix + sizeof(header), sizeof(size));
+    const auto expected =
+        sizeof(prefix) +
+        size_t(size) * (sizeof(triangle) + sizeof(attribute_byte_count_type));
+    if ((file_size == expected) || ((file_size > expected) && !ascii))
+      return file_format::binary;
   }
+
+  return ascii ? file_format::ascii : file_format::binary;
 }
 
 void stl_surface::load_from_ascii_file(const filesystem::path& path) {
-  fstream file{path, ios::in | ios::binary};
-  if (!file.is_open())
-    throw runtime_error("Failed to open STL file from path '"s + path.string() +
-                        "'.");
-
-  string name;
-  string line;
-  getline(file, line);
-  stringstream input{line};
-  string keyword;
-  input >> keyword;
-
-  const auto match = [&](czstring str) {
-    file >> keyword;
-    if (keyword == str) return;
-    throw parser_error("Failed to match keyword '"s + str +
-                       "' in ASCII-based STL file.");
-  };
-
-  if (keyword != "solid")
-    throw parser_error{"Failed to match keyword 'solid' at the start."};
-  input >> name;
-
-  while (file >> keyword) {
-    if (keyword == "endsolid") {
-      match(name.c_str());
-      return;
-    } else if (keyword == "facet") {
-      triangle t{};
-      match("normal");
-      file >> t.normal.x >> t.normal.y >> t.normal.z;
-      match("outer");
-      match("loop");
-      for (int i = 0; i < 3; ++i) {
-        match("vertex");
-        file >> t.vertex[i].x >> t.vertex[i].y >> t.vertex[i].z;
-      }
-      match("endloop");
-      match("endfacet");
-      triangles.push_back(t);
-    } else
-      throw parser_error{"Failed to match keyword 'facet' or 'endsolid'."};
+  // 'memory_mapped_file' throws if the file cannot be opened.
+  const memory_mapped_file file{path};
+  const auto first = file.data();
+  const auto last = file.data() + file.size();
+
+  detail::ascii_facet_parser header_parser{first, last, first};
+  if (header_parser.token() != "solid")
+    header_parser.throw_error("Failed to match keyword 'solid' at the start.");
+  // The name of the solid is not used.
+  header_parser.skip_line();
+  const auto body = header_parser.it;
+
+  // Split the body into chunks at facet boundaries. Every chunk is then
+  // parsed by its own thread. Small files are parsed by a single thread.
+  const size_t size = last - body;
+  const auto count = chunk_count(size, size_t{1} << 20);
+  std::vector<const char*> bounds(count + 1, last);
+  bounds[0] = body;
+  for (size_t i = 1; i < count; ++i) {
+    const auto guess = std::max(bounds[i - 1], body + i * size / count);
+    bounds[i] = detail::next_facet(guess, last);
   }
+
+  // A facet in a typical ASCII-based STL file takes about 250 bytes.
+  std::vector<std::vector<triangle>> chunks(count);
+  parallel_chunks(count, count, [&](size_t chunk, size_t, size_t) {
+    detail::ascii_facet_parser parser{bounds[chunk], bounds[chunk + 1], first};
+    chunks[chunk].reserve((bounds[chunk + 1] - bounds[chunk]) / 250);
+    parser.parse(chunks[chunk]);
+  });
+
+  // Concatenate all chunks in file order.
+  std::vector<size_t> offsets(count + 1, 0);
+  for (size_t i = 0; i < count; ++i)
+    offsets[i + 1] = offsets[i] + chunks[i].size();
+  triangles.resize(offsets.back());
+  parallel_chunks(count, count, [&](size_t chunk, size_t, size_t) {
+    ranges::copy(chunks[chunk], triangles.begin() + offsets[chunk]);
+  });
 }
 
 stl_surface::stl_surface(const filesystem::path& path, binary_tag) {
@@ -92,10 +150,19 @@ stl_surface::stl_surface(const filesystem::path& path, ascii_tag) {
 }
 
 stl_surface::stl_surface(const filesystem::path& path) {
+  // Decide on the format up front. Binary files
+  // do not pay for a failed ASCII parse anymore.
+  if (format_of(path) == file_format::binary) {
+    load_from_binary_file(path);
+    return;
+  }
+  // Binary files whose header looks like text
+  // may still be misclassified as ASCII.
   try {
     load_from_ascii_file(path);
   } catch (parser_error&) {
     load_from_binary_file(path);
   }
 }
+
 }  // namespace ensketch::sandbox
@@ -27,6 +27,15 @@ struct stl_surface {
   static constexpr ascii_tag ascii{};
   static constexpr binary_tag binary{};
 
+  // Determine the format of an STL file by only looking at its size and
+  // header. A file is binary if its size exactly matches the triangle count
+  // stored in the header. A file that starts with 'solid' and whose header
+  // only contains printable characters is considered to be ASCII-based.
+  // Any other file that is large enough for its triangle count is binary.
+  //
+  enum class file_format { ascii, binary };
+  static auto format_of(const filesystem::path& path) -> file_format;
+
   // The whole structure is meant as a typed cache with structure
   // for an underlying file.
   // So, no constructor extensions are used but only good old
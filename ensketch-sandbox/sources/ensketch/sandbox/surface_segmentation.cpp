@@ -0,0 +1,178 @@
+#include <ensketch/sandbox/surface_segmentation.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+using vertex_id = polyhedral_surface::vertex_id;
+using face_id = polyhedral_surface::face_id;
+
+// Call `f(p, q)` for every edge of the curve in order.
+//
+void for_each_edge(const vertex_curve& curve, auto&& f) {
+  const auto& v = curve.vertices;
+  for (size_t i = 1; i < v.size(); ++i) f(v[i - 1], v[i]);
+  if (curve.closed && (v.size() > 2)) f(v.back(), v.front());
+}
+
+auto throw_missing_edge(vertex_id p, vertex_id q) {
+  throw runtime_error(
+      format("Failed to segment surface along curve network. There is "
+             "no edge between the curve vertices {} and {}.",
+             p, q));
+}
+
+// Concurrent union-find over faces without locks. Every parent
+// is accessed atomically and roots are only linked to smaller roots
+// by compare-and-swap. Hence, every root is the smallest face of
+// its set. Path halving may race but only ever shortens paths.
+//
+struct face_forest {
+  explicit face_forest(size_t n) : parents(n) {
+    parallel_for(n, [&](size_t i) { parents[i] = i; });
+  }
+
+  auto parent(face_id x) noexcept -> face_id {
+    return std::atomic_ref<face_id>{parents[x]}.load(
+        std::memory_order_relaxed);
+  }
+
+  auto find(face_id x) noexcept -> face_id {
+    while (true) {
+      const auto p = parent(x);
+      if (p == x) return x;
+      const auto q = parent(p);
+      if (p != q) {
+        auto expected = p;
+        std::atomic_ref<face_id>{parents[x]}.compare_exchange_weak(
+            expected, q, std::memory_order_relaxed);
+      }
+      x = q;
+    }
+  }
+
+  void unite(face_id x, face_id y) noexcept {
+    while (true) {
+      x = find(x);
+      y = find(y);
+      if (x == y) return;
+      if (x < y) swap(x, y);
+      auto expected = x;
+      if (std::atomic_ref<face_id>{parents[x]}.compare_exchange_weak(
+              expected, y, std::memory_order_relaxed))
+        return;
+    }
+  }
+
+  vector<face_id> parents;
+};
+
+}  // namespace
+
+auto surface_segmentation_from(const polyhedral_surface& surface,
+                               std::span<const vertex_curve> curves)
+    -> surface_segmentation {
+  const auto& c = surface.connectivity;
+  const auto face_count = surface.faces.size();
+
+  // Mark both halfedges of every curve edge as cut with one bit each.
+  // Curves are short compared to the surface. So, this is done serially.
+  //
+  constexpr size_t word_bits = 32;
+  vector<uint32> cut((3 * face_count + word_bits - 1) / word_bits, 0);
+  const auto mark = [&](uint32 h) {
+    if (h != polyhedral_surface::invalid)
+      cut[h / word_bits] |= uint32{1} << (h % word_bits);
+  };
+  for (const auto& curve : curves) {
+    for_each_edge(curve, [&](vertex_id p, vertex_id q) {
+      const auto h = c.halfedge(p, q);
+      const auto t = c.halfedge(q, p);
+      if ((h == polyhedral_surface::invalid) &&
+          (t == polyhedral_surface::invalid))
+        throw_missing_edge(p, q);
+      mark(h);
+      mark(t);
+    });
+  }
+  const auto is_cut = [&](uint32 h) {
+    return (cut[h / word_bits] >> (h % word_bits)) & 1u;
+  };
+
+  // Every shared edge that is not cut is united
+  // by the face with the smaller index.
+  //
+  face_forest forest{face_count};
+  parallel_for(face_count, [&](size_t f) {
+    for (uint32 k = 0; k < 3; ++k) {
+      const auto h = 3 * f + k;
+      if (is_cut(h)) continue;
+      const auto g = c.opposite_face(h);
+      if ((g == polyhedral_surface::invalid) || (g < f)) continue;
+      forest.unite(f, g);
+    }
+  });
+
+  // After all unions, roots are the first faces of their regions.
+  // So, counting the roots in face order enumerates the regions.
+  //
+  surface_segmentation result{};
+  result.regions.resize(face_count);
+  parallel_for(face_count, [&](size_t f) {
+    result.regions[f] = forest.find(f);
+  });
+  vector<uint32> ids(face_count);
+  parallel_for(face_count,
+               [&](size_t f) { ids[f] = (result.regions[f] == f); });
+  result._region_count = parallel_exclusive_scan(std::span{ids});
+  parallel_for(face_count, [&](size_t f) {
+    result.regions[f] = ids[result.regions[f]];
+  });
+  return result;
+}
+
+auto bipartition_from(const polyhedral_surface& surface,
+                      std::span<const vertex_id> curve,
+                      bool closed) -> vector<int8> {
+  const auto throw_error = [] {
+    throw runtime_error(
+        "Failed to generate surface bi-partition from given surface vertex "
+        "curve.");
+  };
+  if (curve.empty()) throw_error();
+
+  // Closed curves need at least three distinct vertices to enclose faces.
+  //
+  if (closed) {
+    vector<vertex_id> vertices(curve.begin(), curve.end());
+    std::ranges::sort(vertices);
+    if (std::ranges::unique(vertices).begin() - vertices.begin() < 3)
+      throw_error();
+  }
+
+  const vertex_curve network[]{{curve, closed}};
+  const auto segmentation = surface_segmentation_from(surface, network);
+
+  // Collect the regions on both sides of the curve.
+  // Boundary edges of the curve only have a single side.
+  //
+  vector<int8> sides(segmentation.region_count(), 0);
+  const auto assign = [&](face_id f, int8 side) {
+    if (f == polyhedral_surface::invalid) return;
+    auto& s = sides[segmentation.regions[f]];
+    if (s == -side) throw_error();
+    s = side;
+  };
+  for_each_edge(network[0], [&](vertex_id p, vertex_id q) {
+    assign(surface.face_of(p, q), 1);
+    assign(surface.face_of(q, p), -1);
+  });
+
+  vector<int8> result(surface.faces.size());
+  parallel_for(surface.faces.size(), [&](size_t f) {
+    result[f] = sides[segmentation.regions[f]];
+  });
+  return result;
+}
+
+}  // namespace ensketch::sandbox
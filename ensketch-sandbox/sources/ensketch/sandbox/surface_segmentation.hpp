@@ -0,0 +1,52 @@
+#pragma once
+#include <ensketch/sandbox/polyhedral_surface.hpp>
+
+namespace ensketch::sandbox {
+
+/// Curve along the edges of a surface given by its consecutive vertices.
+/// Closed curves additionally connect their last and first vertex.
+/// The vertices are only referenced and must outlive the curve.
+///
+struct vertex_curve {
+  std::span<const polyhedral_surface::vertex_id> vertices{};
+  bool closed = false;
+};
+
+/// Partition of the faces of a surface into regions. Two faces belong
+/// to the same region if and only if they are connected by a path of
+/// faces that only crosses shared edges that are no part of any cut.
+/// Regions are numbered in the order of their first face.
+///
+struct surface_segmentation {
+  using region_id = uint32;
+
+  auto region_count() const noexcept -> size_t { return _region_count; }
+
+  vector<region_id> regions{};
+  size_t _region_count{};
+};
+
+/// Construct the segmentation of the surface that is induced
+/// by cutting it along all edges of the given curve network. Curves may
+/// cross, touch, and end anywhere. All faces are connected by a parallel
+/// union-find over the edges which needs no traversal order. The roots
+/// are always the faces with the smallest index. So, the result is
+/// deterministic. The surface must have generated edges.
+/// Throws `std::runtime_error` if consecutive curve vertices share no edge.
+///
+auto surface_segmentation_from(const polyhedral_surface& surface,
+                               std::span<const vertex_curve> curves)
+    -> surface_segmentation;
+
+/// Label the faces on both sides of the given curve. The side of the faces
+/// that contain the oriented edges of the curve gets the label 1 and the
+/// other side gets the label -1. Faces of regions that do not touch the
+/// curve get the label 0. See `surface_segmentation_from`.
+/// Throws `std::runtime_error` if both sides lie in the same region
+/// or if a closed curve has fewer than three distinct vertices.
+///
+auto bipartition_from(const polyhedral_surface& surface,
+                      std::span<const polyhedral_surface::vertex_id> curve,
+                      bool closed = true) -> vector<int8>;
+
+}  // namespace ensketch::sandbox
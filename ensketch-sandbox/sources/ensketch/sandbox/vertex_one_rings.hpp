@@ -0,0 +1,125 @@
+#pragma once
+#include <ensketch/sandbox/halfedge_connectivity.hpp>
+
+namespace ensketch::sandbox {
+
+/// Adjacent vertices and faces of all vertices of a triangle surface
+/// in compressed sparse row (CSR) format. Around manifold vertices, both
+/// are cyclically ordered such that face `i` lies between the neighbors
+/// `i` and `i + 1`. Around boundary vertices, the order runs from one
+/// boundary edge to the other and there is one more neighbor than faces.
+/// Non-manifold vertices store their fans one after another.
+///
+struct vertex_one_rings {
+  using vertex_id = uint32;
+  using face_id = uint32;
+
+  auto vertex_count() const noexcept -> size_t {
+    return vertex_offsets.size() - 1;
+  }
+
+  auto vertices_of(vertex_id v) const noexcept -> std::span<const vertex_id> {
+    return {adjacent_vertices.data() + vertex_offsets[v],
+            adjacent_vertices.data() + vertex_offsets[v + 1]};
+  }
+
+  auto faces_of(vertex_id v) const noexcept -> std::span<const face_id> {
+    return {adjacent_faces.data() + face_offsets[v],
+            adjacent_faces.data() + face_offsets[v + 1]};
+  }
+
+  // Check whether `p` and `q` share an edge in any orientation.
+  // One-rings are small. So, a linear scan is fastest.
+  //
+  bool contains(vertex_id p, vertex_id q) const noexcept {
+    if (p >= vertex_count()) return false;
+    return std::ranges::find(vertices_of(p), q) != vertices_of(p).end();
+  }
+
+  vector<uint32> vertex_offsets{0};
+  vector<vertex_id> adjacent_vertices{};
+  vector<uint32> face_offsets{0};
+  vector<face_id> adjacent_faces{};
+};
+
+/// Build the one-rings of the given triangles from their connectivity.
+/// Every face around a vertex owns exactly one of its outgoing halfedges.
+/// So, the face rows reuse the CSR offsets of the connectivity which have
+/// been found by sorting. Every vertex orders its outgoing halfedges by
+/// walking around its fans independently. The neighbor rows are then
+/// counted and filled in two parallel passes. So, construction is
+/// deterministic.
+///
+auto vertex_one_rings_from(const auto& faces,
+                           const halfedge_connectivity& connectivity)
+    -> vertex_one_rings {
+  using halfedge_id = halfedge_connectivity::halfedge_id;
+  constexpr auto invalid = halfedge_connectivity::invalid;
+  const auto& c = connectivity;
+  const auto vertex_count = c.vertex_count();
+  const auto halfedge_count = c.halfedge_count();
+
+  const auto target = [&](halfedge_id h) {
+    return faces[h / 3][(h % 3 == 2) ? 0 : h % 3 + 1];
+  };
+  const auto source = [&](halfedge_id h) { return faces[h / 3][h % 3]; };
+
+  // Outgoing halfedges of every vertex in cyclic order. A fan ends open
+  // at a halfedge whose previous halfedge lies on the boundary.
+  // Every halfedge belongs to the row of exactly one vertex.
+  // Hence, threads never write to the same entries.
+  //
+  vector<halfedge_id> order(halfedge_count);
+  vector<uint8> open(halfedge_count, 0);
+  vector<uint8> visited(halfedge_count, 0);
+
+  vertex_one_rings result{};
+  result.face_offsets = c.offsets;
+  result.adjacent_faces.resize(halfedge_count);
+  result.vertex_offsets.assign(vertex_count + 1, 0);
+  parallel_for(vertex_count, [&](size_t v) {
+    const auto row = c.outgoing(v);
+    auto i = c.offsets[v];
+    // Rotate around the vertex until the boundary or a visited
+    // halfedge is reached. The latter closes the fan.
+    const auto walk = [&](halfedge_id h) {
+      while (!visited[h]) {
+        visited[h] = 1;
+        order[i] = h;
+        const auto t = c.twin(halfedge_connectivity::prev(h));
+        if (t == invalid) {
+          open[i++] = 1;
+          return;
+        }
+        ++i;
+        h = t;
+      }
+    };
+    // Open fans have to start at a boundary halfedge to be complete.
+    for (auto h : row)
+      if (c.twin(h) == invalid) walk(h);
+    for (auto h : row) walk(h);
+
+    size_t count = row.size();
+    for (auto j = c.offsets[v]; j < c.offsets[v + 1]; ++j) {
+      result.adjacent_faces[j] = halfedge_connectivity::face(order[j]);
+      count += open[j];
+    }
+    result.vertex_offsets[v] = count;
+  });
+  visited = {};
+
+  parallel_exclusive_scan(std::span{result.vertex_offsets});
+  result.adjacent_vertices.resize(result.vertex_offsets.back());
+  parallel_for(vertex_count, [&](size_t v) {
+    auto out = result.adjacent_vertices.data() + result.vertex_offsets[v];
+    for (auto j = c.offsets[v]; j < c.offsets[v + 1]; ++j) {
+      *out++ = target(order[j]);
+      if (open[j]) *out++ = source(halfedge_connectivity::prev(order[j]));
+    }
+  });
+
+  return result;
+}
+
+}  // namespace ensketch::sandbox
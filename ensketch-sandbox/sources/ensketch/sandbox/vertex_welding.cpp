@@ -0,0 +1,137 @@
+#include <ensketch/sandbox/vertex_welding.hpp>
+
+namespace ensketch::sandbox {
+
+namespace {
+
+// Finalizer of SplitMix64 to spread all key bits over the whole hash.
+//
+constexpr auto mix(uint64 x) noexcept -> uint64 {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+constexpr auto hash(const vertex_welding_key& key) noexcept -> uint64 {
+  return mix(mix((uint64(key[0]) << 32) | key[1]) ^ key[2]);
+}
+
+}  // namespace
+
+auto vertex_welding_key_from(vec3 position, float32 epsilon) noexcept
+    -> vertex_welding_key {
+  vertex_welding_key key{};
+  if (epsilon > 0) {
+    // Clamp cells to the range of 'int32'. NaNs end up in the lowest cell.
+    constexpr auto min = -0x1p31f;
+    constexpr auto max = 0x1p31f - 128;
+    for (int i = 0; i < 3; ++i) {
+      const auto cell = std::floor(position[i] / epsilon);
+      const auto c = (cell >= min) ? std::min(cell, max) : min;
+      key[i] = std::bit_cast<uint32>(static_cast<int32>(c));
+    }
+  } else {
+    // Adding positive zero maps negative zero onto positive zero.
+    for (int i = 0; i < 3; ++i)
+      key[i] = std::bit_cast<uint32>(position[i] + 0.0f);
+  }
+  return key;
+}
+
+auto vertex_welding_from(std::span<const vertex_welding_key> keys)
+    -> vertex_welding {
+  using size_type = vertex_welding::size_type;
+  const auto size = keys.size();
+  if (size > std::numeric_limits<size_type>::max())
+    throw std::runtime_error(std::format(
+        "Failed to weld vertices. The point count {} is too large.", size));
+
+  vertex_welding result{};
+  result.offsets.assign(1, 0);
+  if (size == 0) return result;
+
+  // Sort the point indices by the hash of their keys.
+  // The radix sort is stable. So, indices within runs of equal hashes
+  // stay in ascending order.
+  //
+  vector<uint64> hashes(size);
+  vector<size_type> order(size);
+  parallel_for(size, [&](size_t i) {
+    hashes[i] = hash(keys[i]);
+    order[i] = i;
+  });
+  parallel_radix_sort(hashes, order);
+
+  // Process all elements of `order` in parallel by groups.
+  // A group is a maximal range of elements for which `same(i - 1, i)`
+  // holds. Chunk boundaries are moved forward to group boundaries.
+  // So, every group is processed by exactly one thread.
+  //
+  const auto for_each_group = [size](auto&& same, auto&& f) {
+    parallel_for_chunks(size, [&](size_t first, size_t last) {
+      while ((first > 0) && (first < size) && same(first - 1, first)) ++first;
+      while (first < last) {
+        auto next = first + 1;
+        while ((next < size) && same(next - 1, next)) ++next;
+        f(first, next);
+        first = next;
+      }
+    });
+  };
+
+  // Inside runs of equal hashes, sort by full keys to resolve collisions.
+  // Each point gets mapped to the smallest point index with the same key.
+  //
+  vector<size_type> remap(size);
+  for_each_group(
+      [&](size_t i, size_t j) { return hashes[i] == hashes[j]; },
+      [&](size_t first, size_t last) {
+        const auto begin = order.begin() + first;
+        const auto end = order.begin() + last;
+        const auto& key = keys[*begin];
+        if (!std::all_of(begin, end, [&](auto i) { return keys[i] == key; }))
+          std::sort(begin, end, [&](auto i, auto j) {
+            return std::tie(keys[i], i) < std::tie(keys[j], j);
+          });
+        auto representative = *begin;
+        for (auto it = begin; it != end; ++it) {
+          if (keys[*it] != keys[representative]) representative = *it;
+          remap[*it] = representative;
+        }
+      });
+
+  // Enumerate representatives in ascending order to get vertex IDs
+  // that follow the order of first appearance.
+  //
+  vector<size_type> ids(size);
+  parallel_for(size, [&](size_t i) { ids[i] = (remap[i] == i); });
+  const auto vertex_count = parallel_exclusive_scan(std::span{ids});
+  parallel_for(size, [&](size_t i) { remap[i] = ids[remap[i]]; });
+  ids = {};
+  hashes = {};
+
+  // Generate the inverse mapping from vertices to points.
+  // Points of the same vertex are stored consecutively in `order`.
+  //
+  const auto same_vertex = [&](size_t i, size_t j) {
+    return remap[order[i]] == remap[order[j]];
+  };
+  result.offsets.assign(vertex_count + 1, 0);
+  for_each_group(same_vertex, [&](size_t first, size_t last) {
+    result.offsets[remap[order[first]]] = last - first;
+  });
+  parallel_exclusive_scan(std::span{result.offsets});
+  result.points.resize(size);
+  for_each_group(same_vertex, [&](size_t first, size_t last) {
+    std::copy(order.begin() + first, order.begin() + last,
+              result.points.begin() + result.offsets[remap[order[first]]]);
+  });
+
+  result.remap = std::move(remap);
+  return result;
+}
+
+}  // namespace ensketch::sandbox
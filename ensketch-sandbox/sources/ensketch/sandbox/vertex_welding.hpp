@@ -0,0 +1,66 @@
+#pragma once
+#include <ensketch/sandbox/parallel.hpp>
+#include <ensketch/sandbox/utility.hpp>
+
+namespace ensketch::sandbox {
+
+/// Result of merging coinciding points into shared vertices.
+/// Vertex IDs are assigned in the order of the first appearance
+/// of their points. Hence, welding is deterministic and
+/// already welded input is mapped onto itself.
+///
+struct vertex_welding {
+  using size_type = uint32;
+
+  auto vertex_count() const noexcept -> size_t { return offsets.size() - 1; }
+
+  // For every welded vertex `v`, return the smallest index
+  // of all input points that have been merged into `v`.
+  //
+  auto representative(size_type v) const noexcept -> size_type {
+    return points[offsets[v]];
+  }
+
+  // For every input point, the ID of its welded vertex.
+  //
+  vector<size_type> remap{};
+
+  // For every welded vertex `v`, the merged input points are
+  // given by the range `points[offsets[v]]` to `points[offsets[v + 1]]`.
+  // The points of every vertex are stored in ascending order.
+  //
+  vector<size_type> offsets{};
+  vector<size_type> points{};
+};
+
+/// Points with equal keys are merged into the same vertex.
+/// For exact welding, the key consists of the bit representation
+/// of the coordinates with positive and negative zero identified.
+/// For a positive `epsilon`, coordinates are quantized to the cells
+/// of a uniform grid with cell size `epsilon` instead.
+///
+using vertex_welding_key = array<uint32, 3>;
+
+auto vertex_welding_key_from(vec3 position, float32 epsilon = 0) noexcept
+    -> vertex_welding_key;
+
+/// Weld points given by their keys.
+/// Keys are hashed and radix-sorted in parallel. Runs of equal hashes
+/// are afterwards resolved by comparing the full keys. So, hash
+/// collisions never lead to wrong merges.
+///
+auto vertex_welding_from(std::span<const vertex_welding_key> keys)
+    -> vertex_welding;
+
+/// Weld `count` points whose positions are given by `position(i)`.
+///
+auto vertex_welding_from(size_t count, auto&& position, float32 epsilon = 0)
+    -> vertex_welding {
+  vector<vertex_welding_key> keys(count);
+  parallel_for(count, [&](size_t i) {
+    keys[i] = vertex_welding_key_from(std::invoke(position, i), epsilon);
+  });
+  return vertex_welding_from(keys);
+}
+
+}  // namespace ensketch::sandbox
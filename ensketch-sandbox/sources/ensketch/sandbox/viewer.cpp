@@ -3,6 +3,7 @@
 #include <ensketch/sandbox/defaults.hpp>
 #include <ensketch/sandbox/hyper_surface_smoothing.hpp>
 #include <ensketch/sandbox/log.hpp>
+#include <ensketch/sandbox/quantized_vertices.hpp>
 #include <ensketch/sandbox/ray_tracer.hpp>
 //
 #include <ensketch/opengl/shader_object.hpp>
@@ -14,7 +15,6 @@
 //
 #include <igl/avg_edge_length.h>
 //
-#define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
 namespace ensketch::sandbox {
@@ -93,6 +93,7 @@ void viewer::init() {
   device = device_storage{};
 
   const auto vs = opengl::vertex_shader{"#version 460 core\n",  //
+                                        quantized_vertex_decoding,  //
                                         R"##(
 uniform mat4 projection;
 uniform mat4 view;
@@ -100,16 +101,20 @@ uniform mat4 view;
 layout (location = 0) in vec3 p;
 layout (location = 1) in vec3 n;
 layout (location = 2) in float f;
+layout (location = 3) in float o;
 
 out vec3 position;
 out vec3 normal;
 out float field;
+out float occlusion;
 
 void main() {
-  gl_Position = projection * view * vec4(p, 1.0);
-  position = vec3(view * vec4(p, 1.0));
-  normal = vec3(view * vec4(n, 0.0));
+  vec3 x = decode_position(p);
+  gl_Position = projection * view * vec4(x, 1.0);
+  position = vec3(view * vec4(x, 1.0));
+  normal = vec3(view * vec4(decode_normal(n), 0.0));
   field = f;
+  occlusion = o;
 }
 )##"};
 
@@ -125,12 +130,14 @@ layout (triangle_strip, max_vertices = 3) out;
 in vec3 position[];
 in vec3 normal[];
 in float field[];
+in float occlusion[];
 
 out vec3 pos;
 out vec3 nor;
 out vec3 vnor;
 noperspective out vec3 edge_distance;
 out float phi;
+out float ao;
 
 void main(){
   vec3 p0 = vec3(viewport * (gl_in[0].gl_Position /
@@ -160,6 +167,7 @@ void main(){
   vnor = normal[0];
   pos = position[0];
   phi = field[0];
+  ao = occlusion[0];
   gl_Position = gl_in[0].gl_Position;
   EmitVertex();
 
@@ -168,6 +176,7 @@ void main(){
   vnor = normal[1];
   pos = position[1];
   phi = field[1];
+  ao = occlusion[1];
   gl_Position = gl_in[1].gl_Position;
   EmitVertex();
 
@@ -176,6 +185,7 @@ void main(){
   vnor = normal[2];
   pos = position[2];
   phi = field[2];
+  ao = occlusion[2];
   gl_Position = gl_in[2].gl_Position;
   EmitVertex();
 
@@ -190,17 +200,27 @@ void main(){
 
 uniform bool wireframe = false;
 uniform bool use_face_normal = false;
+uniform bool use_ambient_occlusion = false;
+// Faces of preview LODs do not match the selected faces.
+uniform bool preview = false;
 
 in vec3 pos;
 in vec3 nor;
 in vec3 vnor;
 noperspective in vec3 edge_distance;
 in float phi;
+in float ao;
 
 layout (location = 0) out vec4 frag_color;
 
+// Signed 8-bit labels of the surface bi-partition, four per word.
 layout (std430, binding = 0) readonly buffer ssbo {
-  float label[];
+  uint labels[];
+};
+
+// One bit per face for the selected region.
+layout (std430, binding = 1) readonly buffer selection {
+  uint selected_faces[];
 };
 
 float colormap_h(float x) {
@@ -308,11 +328,17 @@ void main() {
     s = abs(normalize(nor).z);
 
   float light = 0.2 + 1.0 * pow(s, 1000) + 0.75 * pow(s, 0.2);
+  if (use_ambient_occlusion) light *= ao;
 
   // float light = 0.2 + 0.75 * pow(s, 0.2);
 
   vec4 light_color = vec4(vec3(light), alpha);
 
+  uint word = uint(gl_PrimitiveID) / 32u;
+  if (!preview && (word < selected_faces.length()) &&
+      (((selected_faces[word] >> (uint(gl_PrimitiveID) % 32u)) & 1u) != 0u))
+    light_color *= vec4(0.9, 0.5, 0.1, 1.0);
+
   // Mix both color values.
 
   float transition = 0.5;
@@ -356,9 +382,9 @@ void main() {
     return;
   }
 
-  const auto level_set_vs = opengl::vertex_shader{R"##(
-#version 460 core
-
+  const auto level_set_vs = opengl::vertex_shader{"#version 460 core\n",  //
+                                                  quantized_vertex_decoding,
+                                                  R"##(
 uniform mat4 projection;
 uniform mat4 view;
 
@@ -368,7 +394,7 @@ layout (location = 2) in float f;
 out float field;
 
 void main() {
-  gl_Position = projection * view * vec4(p, 1.0);
+  gl_Position = projection * view * vec4(decode_position(p), 1.0);
   field = f;
 }
 )##"};
@@ -556,16 +582,16 @@ void main() {
     return;
   }
 
-  const auto point_vs = opengl::vertex_shader{R"##(
-#version 460 core
-
+  const auto point_vs = opengl::vertex_shader{"#version 460 core\n",  //
+                                              quantized_vertex_decoding,
+                                              R"##(
 uniform mat4 projection;
 uniform mat4 view;
 
 layout (location = 0) in vec3 p;
 
 void main(){
-  gl_Position = projection * view * vec4(p, 1.0);
+  gl_Position = projection * view * vec4(decode_position(p), 1.0);
 }
 )##"};
 
@@ -606,6 +632,93 @@ void main() {
     return;
   }
 
+  // The pick shader writes the face ID plus one, the barycentric
+  // coordinates, and the distance to the camera of every pixel.
+  // Zero is kept as face ID for the background.
+  //
+  const auto pick_vs = opengl::vertex_shader{"#version 460 core\n",  //
+                                             quantized_vertex_decoding,
+                                             R"##(
+uniform mat4 projection;
+uniform mat4 view;
+
+layout (location = 0) in vec3 p;
+
+out vec3 position;
+
+void main(){
+  vec3 x = decode_position(p);
+  gl_Position = projection * view * vec4(x, 1.0);
+  position = vec3(view * vec4(x, 1.0));
+}
+)##"};
+
+  const auto pick_gs = opengl::geometry_shader{R"##(
+#version 460 core
+
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+in vec3 position[];
+
+out vec3 pos;
+out vec2 barycentric;
+
+void main(){
+  const vec2 corners[3] =
+      vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0));
+  for (int i = 0; i < 3; ++i) {
+    gl_PrimitiveID = gl_PrimitiveIDIn;
+    pos = position[i];
+    barycentric = corners[i];
+    gl_Position = gl_in[i].gl_Position;
+    EmitVertex();
+  }
+  EndPrimitive();
+}
+)##"};
+
+  const auto pick_fs = opengl::fragment_shader{R"##(
+#version 460 core
+
+in vec3 pos;
+in vec2 barycentric;
+
+layout (location = 0) out uvec4 pick;
+
+void main() {
+  pick = uvec4(uint(gl_PrimitiveID) + 1u,
+               floatBitsToUint(barycentric.x),
+               floatBitsToUint(barycentric.y),
+               floatBitsToUint(length(pos)));
+}
+)##"};
+
+  if (!pick_vs) {
+    log::error(pick_vs.info_log());
+    return;
+  }
+
+  if (!pick_gs) {
+    log::error(pick_gs.info_log());
+    return;
+  }
+
+  if (!pick_fs) {
+    log::error(pick_fs.info_log());
+    return;
+  }
+
+  device->pick_shader.attach(pick_vs);
+  device->pick_shader.attach(pick_gs);
+  device->pick_shader.attach(pick_fs);
+  device->pick_shader.link();
+
+  if (!device->pick_shader.linked()) {
+    log::error(device->pick_shader.info_log());
+    return;
+  }
+
   device->va.bind();
   device->vertices.bind();
   device->faces.bind();
@@ -623,21 +736,45 @@ void main() {
   glEnableVertexAttribArray(2);
   glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
 
+  device->ambient_occlusion.bind();
+  glEnableVertexAttribArray(3);
+  glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+
+  // The preview LOD has neither a scalar field nor compact vertices.
+  // Its vertices only consist of positions and normals.
+  //
+  device->lod_va.bind();
+  device->lod_vertices.bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
+                        sizeof(polyhedral_surface::vertex),
+                        (void*)offsetof(polyhedral_surface::vertex, position));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE,
+                        sizeof(polyhedral_surface::vertex),
+                        (void*)offsetof(polyhedral_surface::vertex, normal));
+  glDisableVertexAttribArray(2);
+  device->lod_ambient_occlusion.bind();
+  glEnableVertexAttribArray(3);
+  glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, device->ssbo.id());
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, device->ssbo.id());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1,
+                   device->selected_region_faces.id());
 
   // surface_should_update = true;
 
-  const auto surface_vertex_curve_vs = opengl::vertex_shader{R"##(
-#version 460 core
-
+  const auto surface_vertex_curve_vs =
+      opengl::vertex_shader{"#version 460 core\n",  //
+                            quantized_vertex_decoding, R"##(
 uniform mat4 projection;
 uniform mat4 view;
 
 layout (location = 0) in vec3 p;
 
 void main(){
-  gl_Position = projection * view * vec4(p, 1.0);
+  gl_Position = projection * view * vec4(decode_position(p), 1.0);
 }
 )##"};
 
@@ -866,6 +1003,7 @@ void viewer::free() {
 void viewer::resize(int width, int height) {
   glViewport(0, 0, width, height);
   camera.set_screen_resolution(width, height);
+  if (device) device->picks.resize(width, height);
   view_should_update = true;
 }
 
@@ -921,6 +1059,11 @@ void viewer::process_events() {
           reset_surface_mesh_curve();
           reset_surface_bipartition();
           reset_surface_scalar_field();
+          reset_surface_selection();
+          break;
+        case sf::Keyboard::L:
+          select_surface_region_from_mouse_curve(
+              !sf::Keyboard::isKeyPressed(sf::Keyboard::LShift));
           break;
         case sf::Keyboard::G:
           compute_surface_geodesic();
@@ -950,6 +1093,22 @@ void viewer::process_events() {
         case sf::Keyboard::H:
           compute_hyper_surface_smoothing();
           break;
+        case sf::Keyboard::O:
+          // Shift bakes the ambient occlusion again.
+          if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift))
+            bake_ambient_occlusion();
+          else
+            set_ambient_occlusion(!ambient_occlusion_enabled);
+          break;
+        case sf::Keyboard::T:
+          reorder_surface();
+          break;
+        case sf::Keyboard::Q:
+          set_compact_vertices(!compact_vertices);
+          break;
+        case sf::Keyboard::D:
+          set_preview_lod(!preview_lod_enabled);
+          break;
       }
     }
   }
@@ -970,10 +1129,19 @@ void viewer::process_events() {
 
 void viewer::update() {
   handle_surface_load_task();
+  handle_ambient_occlusion_task();
+  handle_surface_lod_task();
+
+  // Answer all picks whose readbacks have finished. Their callbacks
+  // read the surface. So, they wait while it is loaded by another
+  // thread and are dropped below if it has been replaced.
+  if (!surface_load_task.valid() && !surface_should_update)
+    device->picks.poll();
 
   if (view_should_update) {
     update_view();
     view_should_update = false;
+    last_view_change = clock::now();
   }
 
   if (surface_should_update) {
@@ -981,18 +1149,37 @@ void viewer::update() {
 
     compute_heat_data();
 
-    device->vertices.allocate_and_initialize(surface.vertices);
+    upload_surface_vertices();
     device->faces.allocate_and_initialize(surface.faces);
 
+    reset_surface_bipartition();
+
     vector<float> tmp{};
-    tmp.assign(surface.faces.size(), 0.0f);
-    device->ssbo.allocate_and_initialize(tmp);
     tmp.assign(surface.vertices.size(), 0.0f);
     device->scalar_field.allocate_and_initialize(tmp);
+    // Without baked values, the surface is shown without occlusion.
+    if (surface.ambient_occlusion.size() == surface.vertices.size())
+      device->ambient_occlusion.allocate_and_initialize(
+          surface.ambient_occlusion);
+    else {
+      tmp.assign(surface.vertices.size(), 1.0f);
+      device->ambient_occlusion.allocate_and_initialize(tmp);
+    }
+
+    reset_surface_selection();
+    // Picks refer to the faces of the previous surface.
+    device->picks.clear();
 
     surface_should_update = false;
   }
 
+  // The LODs are built after the surface has completely been loaded.
+  //
+  if (surface_lods_should_update && !surface_load_task.valid()) {
+    build_surface_lods();
+    surface_lods_should_update = false;
+  }
+
   if (mouse_curve_recording) record_mouse_curve();
 }
 
@@ -1037,6 +1224,9 @@ void viewer::update_view() {
     device->point_shader.try_set("view", camera.view_matrix());
     device->point_shader.try_set("viewport", camera.viewport_matrix());
 
+    device->pick_shader.try_set("projection", camera.projection_matrix());
+    device->pick_shader.try_set("view", camera.view_matrix());
+
     device->surface_vertex_curve_shader.try_set("projection",
                                                 camera.projection_matrix());
     device->surface_vertex_curve_shader.try_set("view", camera.view_matrix());
@@ -1056,14 +1246,49 @@ void viewer::update_view() {
 }
 
 void viewer::render() {
+  glDepthFunc(GL_LEQUAL);
+
+  // The ID buffer is only rendered in frames with pick requests.
+  // The multisampled default framebuffer cannot be combined with
+  // its integer attachment. So, the faces are drawn a second time.
+  //
+  if (device->picks.has_requests()) {
+    device->picks.begin();
+    device->va.bind();
+    device->faces.bind();
+    device->pick_shader.use();
+    glDrawElements(GL_TRIANGLES, 3 * surface.faces.size(), GL_UNSIGNED_INT, 0);
+    device->picks.end();
+  }
+
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  glDepthFunc(GL_LEQUAL);
+  // Stored images always show the surface at full resolution.
+  // While loading, the LODs are changed by another thread.
+  //
+  const bool preview =
+      preview_lod_enabled && !surface_load_task.valid() &&
+      (preview_lod < surface_lods.size()) && store_image_path.empty() &&
+      (duration(clock::now() - last_view_change).count() < preview_delay);
 
-  device->va.bind();
-  device->faces.bind();
   device->shader.use();
-  glDrawElements(GL_TRIANGLES, 3 * surface.faces.size(), GL_UNSIGNED_INT, 0);
+  device->shader.set("preview", preview);
+  if (preview) {
+    device->shader.set("quantized", false);
+    device->lod_va.bind();
+    device->lod_faces.bind();
+    // Without scalar field, the LOD is shown without level sets.
+    glVertexAttrib1f(2, 0.0f);
+    glDrawElements(GL_TRIANGLES,
+                   3 * surface_lods[preview_lod].surface.faces.size(),
+                   GL_UNSIGNED_INT, 0);
+  } else {
+    device->shader.set("quantized", compact_vertices);
+    device->va.bind();
+    device->faces.bind();
+    glDrawElements(GL_TRIANGLES, 3 * surface.faces.size(), GL_UNSIGNED_INT,
+                   0);
+  }
   // glDrawArrays(GL_TRIANGLES, 0, 3);
 
   glDepthFunc(GL_ALWAYS);
@@ -1072,6 +1297,7 @@ void viewer::render() {
     device->va.bind();
     device->surface_vertex_curve_data.bind();
     device->surface_vertex_curve_shader.use();
+    device->surface_vertex_curve_shader.set("quantized", compact_vertices);
     device->surface_vertex_curve_shader.set("line_width", 3.5f);
     device->surface_vertex_curve_shader.set("line_color",
                                             vec4{vec3{0.5f}, 0.8f});
@@ -1081,17 +1307,22 @@ void viewer::render() {
         GL_UNSIGNED_INT, 0);
   }
 
-  device->va.bind();
-  device->faces.bind();
-  device->level_set_shader.set("line_width", 3.5f);
-  device->level_set_shader.set("line_color", vec4{0.9, 0.5, 0.1, 0.8});
-  device->level_set_shader.use();
-  glDrawElements(GL_TRIANGLES, 3 * surface.faces.size(), GL_UNSIGNED_INT, 0);
+  if (!preview) {
+    device->va.bind();
+    device->faces.bind();
+    device->level_set_shader.set("line_width", 3.5f);
+    device->level_set_shader.set("line_color", vec4{0.9, 0.5, 0.1, 0.8});
+    device->level_set_shader.use();
+    glDrawElements(GL_TRIANGLES, 3 * surface.faces.size(), GL_UNSIGNED_INT,
+                   0);
+  }
 
   if (!surface_mesh_curve.empty()) {
     device->surface_mesh_curve_va.bind();
     device->surface_mesh_curve_data.bind();
     device->surface_vertex_curve_shader.use();
+    // Points of the mesh curve are never quantized.
+    device->surface_vertex_curve_shader.set("quantized", false);
     device->surface_vertex_curve_shader.set("line_width", 3.5f);
     device->surface_vertex_curve_shader.set("line_color",
                                             vec4{0.2, 0.6, 0.95, 0.8});
@@ -1105,6 +1336,14 @@ void viewer::render() {
     glDrawElements(GL_POINTS, 1, GL_UNSIGNED_INT, 0);
   }
 
+  if (!selected_region_vertices.empty()) {
+    device->va.bind();
+    device->selected_region_vertices.bind();
+    device->point_shader.use();
+    glDrawElements(GL_POINTS, selected_region_vertices.size(),
+                   GL_UNSIGNED_INT, 0);
+  }
+
   if (!mouse_curve.empty()) {
     device->mouse_curve_va.bind();
     device->mouse_curve_data.bind();
@@ -1234,12 +1473,16 @@ void viewer::zoom(float scale) {
 }
 
 void viewer::look_at(float x, float y) {
-  const auto r = primary_ray(camera, x, y);
-  if (const auto p = intersection(r, surface)) {
-    origin = r(p.t);
+  if (!device) return;
+  device->picks.request(x, y, [this](const pick_buffer::hit& p) {
+    if (p.f >= surface.faces.size()) return;
+    const auto& f = surface.faces[p.f];
+    const auto& v = surface.vertices;
+    origin = (1.0f - p.u - p.v) * v[f[0]].position + p.u * v[f[1]].position +
+             p.v * v[f[2]].position;
     radius = p.t;
     view_should_update = true;
-  }
+  });
 }
 
 void viewer::set_z_as_up() {
@@ -1259,16 +1502,27 @@ void viewer::set_y_as_up() {
 void viewer::load_surface(const filesystem::path& path) {
   // const auto p = app().path_from_lookup(path);
   const auto p = path;
+  cancel_ambient_occlusion_bake();
+  cancel_surface_lod_build();
   try {
     const auto load_start = clock::now();
 
+    const auto stamp = polyhedral_surface_cache::stamp_of(p);
     surface = polyhedral_surface_from(p);
-    surface.generate_edges();
+    surface_path = p;
+    surface_stamp = stamp;
+    surface_modified = false;
 
     const auto load_end = clock::now();
 
+    surface_bvh = bvh_from(surface);
+    surface_kd_tree = kd_tree_from(surface);
+
+    const auto process_end = clock::now();
+
     // Evaluate loading and processing time.
     surface_load_time = duration(load_end - load_start).count();
+    surface_process_time = duration(process_end - load_end).count();
 
     // surface.update();
     fit_view_to_surface();
@@ -1276,6 +1530,7 @@ void viewer::load_surface(const filesystem::path& path) {
     compute_surface_topology_and_geometry();
 
     surface_should_update = true;
+    surface_lods_should_update = true;
 
     log::info(format("Sucessfully loaded surface mesh from file.\nfile = '{}'",
                      p.string()));
@@ -1295,6 +1550,11 @@ void viewer::async_load_surface(const filesystem::path& path) {
         path.string()));
     return;
   }
+  // The LODs are read by the rendering and have to be
+  // discarded on this thread before the loading starts.
+  // Pending picks refer to the faces of the old surface.
+  cancel_surface_lod_build();
+  if (device) device->picks.clear();
   surface_load_task =
       async(launch::async, [this, &path] { load_surface(path); });
   log::info(format(
@@ -1339,33 +1599,15 @@ void viewer::print_surface_info() {
 auto viewer::surface_vertex_from(const mouse_position& m) noexcept
     -> polyhedral_surface::vertex_id {
   const auto r = primary_ray(camera, m.x, m.y);
-  const auto p = intersection(r, surface);
-  if (!p) return polyhedral_surface::invalid;
-
-  const auto& f = surface.faces[p.f];
-  const auto w = real(1) - p.u - p.v;
-
-  const auto position = surface.vertices[f[0]].position * w +
-                        surface.vertices[f[1]].position * p.u +
-                        surface.vertices[f[2]].position * p.v;
-
-  const auto l0 = length(position - surface.vertices[f[0]].position);
-  const auto l1 = length(position - surface.vertices[f[1]].position);
-  const auto l2 = length(position - surface.vertices[f[2]].position);
-
-  if (l0 <= l1) {
-    if (l0 <= l2)
-      return f[0];
-    else
-      return f[2];
-  } else {
-    if (l1 <= l2)
-      return f[1];
-    else
-      return f[2];
-  }
+  return nearest_vertex(surface, intersection(r, surface, surface_bvh));
+}
 
-  return polyhedral_surface::invalid;
+auto viewer::surface_vertices_from(span<const vec2> positions)
+    -> vector<polyhedral_surface::vertex_id> {
+  const auto hits = intersections(camera, positions, surface, surface_bvh);
+  vector<polyhedral_surface::vertex_id> result(hits.size());
+  for (size_t i = 0; i < hits.size(); ++i) result[i] = hits[i].vertex;
+  return result;
 }
 
 void viewer::select_surface_vertex_from_mouse(float x, float y) noexcept {
@@ -1386,13 +1628,47 @@ void viewer::record_mouse_curve() noexcept {
   if (device) device->mouse_curve_data.allocate_and_initialize(mouse_curve);
 }
 
+void viewer::select_surface_region_from_mouse_curve(bool visible_only) {
+  const auto region = screen_region_from(mouse_curve);
+  const auto vertices =
+      visible_only ? select_visible_vertices(camera, surface, surface_kd_tree,
+                                             surface_bvh, region)
+                   : select_vertices(camera, surface, surface_kd_tree, region);
+  selected_region_faces =
+      visible_only ? select_visible_faces(camera, surface, surface_bvh, region)
+                   : select_faces(camera, surface, surface_bvh, region);
+  selected_region_vertices = vertices.indices();
+
+  // Both selections are uploaded in a single transfer each.
+  //
+  if (device) {
+    device->selected_region_vertices.allocate_and_initialize(
+        selected_region_vertices);
+    device->selected_region_faces.allocate_and_initialize(
+        selected_region_faces.words);
+  }
+
+  log::info(format("Selected {} vertices and {} faces.",
+                   selected_region_vertices.size(),
+                   selected_region_faces.count()));
+}
+
+void viewer::reset_surface_selection() {
+  selected_region_vertices.clear();
+  selected_region_faces = selection_mask(surface.faces.size());
+  if (device)
+    device->selected_region_faces.allocate_and_initialize(
+        selected_region_faces.words);
+}
+
 void viewer::project_mouse_curve_to_surface_vertex_curve() {
   surface_vertex_curve.clear();
   surface_vertex_curve_closed = false;
 
-  for (auto& m : mouse_curve) {
-    const auto x = surface_vertex_from(mouse_position{m.x, m.y});
-
+  // Project all mouse positions at once.
+  // For long curves, this is much faster than one ray at a time.
+  //
+  for (const auto x : surface_vertices_from(mouse_curve)) {
     if (x == polyhedral_surface::invalid) continue;
 
     if (surface_vertex_curve.empty()) {
@@ -1498,7 +1774,7 @@ void viewer::regularize_open_surface_vertex_curve() {
       continue;
     }
 
-    if (surface.edges.contains({q, x}) || surface.edges.contains({x, q})) {
+    if (surface.adjacent(q, x)) {
       curve[count - 1] = x;  // remove previous and push back current
       continue;
     }
@@ -1583,9 +1859,15 @@ void viewer::reset_surface_vertex_curve() {
 }
 
 void viewer::mouse_append_surface_vertex_curve(float x, float y) {
-  const auto vid = surface_vertex_from(mouse_position{x, y});
-  if (vid == polyhedral_surface::invalid) return;
+  if (!device) return;
+  device->picks.request(x, y, [this](const pick_buffer::hit& p) {
+    if (p.f >= surface.faces.size()) return;
+    shortest_path_append_to_surface_vertex_curve(nearest_vertex(surface, p));
+  });
+}
 
+void viewer::shortest_path_append_to_surface_vertex_curve(
+    polyhedral_surface::vertex_id vid) {
   if (surface_vertex_curve.empty()) {
     surface_vertex_curve.push_back(vid);
     return;
@@ -1647,7 +1929,7 @@ void viewer::regular_append_to_surface_vertex_curve(
     return;
   }
 
-  if (surface.edges.contains({q, vid}) || surface.edges.contains({vid, q})) {
+  if (surface.adjacent(q, vid)) {
     curve[count - 1] = vid;  // remove previous and push back current
     return;
   }
@@ -1991,8 +2273,8 @@ void viewer::compute_surface_bipartition_from_surface_vertex_curve() {
 }
 
 void viewer::reset_surface_bipartition() {
-  vector<float> tmp{};
-  tmp.assign(surface.faces.size(), 0.0f);
+  vector<int8> tmp{};
+  tmp.assign(surface.faces.size(), 0);
   device->ssbo.allocate_and_initialize(tmp);
 }
 
@@ -2027,7 +2309,7 @@ void viewer::compute_hyper_surface_smoothing() try {
                                           surface_vertex_curve_closed);
 
   for (uint pid = 0; pid < m.num_polys(); ++pid)
-    m.poly_data(pid).label = (face_mask[pid] < 0.0f) ? 0 : 1;
+    m.poly_data(pid).label = (face_mask[pid] < 0) ? 0 : 1;
 
   const auto start = clock::now();
   ScalarField res =
@@ -2105,4 +2387,239 @@ void viewer::use_face_normal(bool value) {
   device->shader.set("use_face_normal", value);
 }
 
+void viewer::set_ambient_occlusion(bool value) {
+  ambient_occlusion_enabled = value;
+  device->shader.set("use_ambient_occlusion", value);
+  if (value && surface.ambient_occlusion.empty() &&
+      !surface_ambient_occlusion_bake)
+    bake_ambient_occlusion();
+}
+
+void viewer::bake_ambient_occlusion() {
+  if (surface_load_task.valid()) {
+    log::error(
+        "Failed to start baking of ambient occlusion.\nThe surface mesh is "
+        "still loading.");
+    return;
+  }
+  cancel_ambient_occlusion_bake();
+  surface_ambient_occlusion_start = clock::now();
+  surface_ambient_occlusion_bake.emplace(surface, surface_bvh);
+  surface_ambient_occlusion_task = async(
+      launch::async, [this] { surface_ambient_occlusion_bake->refine(); });
+  log::info(format("Started baking of ambient occlusion for {} vertices.",
+                   surface.vertices.size()));
+}
+
+void viewer::handle_ambient_occlusion_task() {
+  // While loading, the surface is changed by another thread.
+  if (surface_load_task.valid()) return;
+  if (!surface_ambient_occlusion_task.valid()) return;
+  if (future_status::ready != surface_ambient_occlusion_task.wait_for(0s))
+    return;
+  surface_ambient_occlusion_task.get();
+
+  // Show the estimate of every finished pass and start the next one.
+  //
+  auto& bake = *surface_ambient_occlusion_bake;
+  device->ambient_occlusion.allocate_and_initialize(bake.values());
+  if (!bake.done()) {
+    surface_ambient_occlusion_task =
+        async(launch::async, [&bake] { bake.refine(); });
+    return;
+  }
+
+  surface.ambient_occlusion.assign(bake.values().begin(), bake.values().end());
+  upload_preview_lod();
+  log::info(format(
+      "Successfully baked ambient occlusion.\nrays = {}\ntime = {} s",
+      bake.sample_count() * surface.vertices.size(),
+      duration(clock::now() - surface_ambient_occlusion_start).count()));
+  surface_ambient_occlusion_bake.reset();
+
+  // Failing to write the cache only affects later loads.
+  //
+  if (surface_path.empty() || surface_modified) return;
+  try {
+    if (!update_cache(surface_path, surface_stamp, surface))
+      log::warn(format("Skipped update of outdated cache.\nfile = '{}'",
+                       surface_path.string()));
+  } catch (runtime_error& e) {
+    log::warn(e.what());
+  }
+}
+
+void viewer::cancel_ambient_occlusion_bake() {
+  // A running pass cannot be interrupted and has to finish first.
+  if (surface_ambient_occlusion_task.valid())
+    surface_ambient_occlusion_task.wait();
+  surface_ambient_occlusion_task = {};
+  surface_ambient_occlusion_bake.reset();
+}
+
+void viewer::reorder_surface() {
+  // The bake and the LODs refer to the old vertex order.
+  cancel_ambient_occlusion_bake();
+  cancel_surface_lod_build();
+
+  const auto start = clock::now();
+  const auto reordering = reorder(surface);
+  surface_modified = true;
+  surface_bvh = bvh_from(surface);
+  surface_kd_tree = kd_tree_from(surface);
+  const auto end = clock::now();
+
+  // Curves and selections are only remapped. The selected faces are
+  // stored as bits and are moved by the face permutation.
+  //
+  const auto& map = reordering.vertices.map;
+  for (auto& v : surface_vertex_curve) v = map[v];
+  for (auto& v : selected_region_vertices) v = map[v];
+  std::ranges::sort(selected_region_vertices);
+  if (selected_vertex != polyhedral_surface::invalid)
+    selected_vertex = map[selected_vertex];
+  if (selected_region_faces.size() == surface.faces.size()) {
+    selection_mask faces(surface.faces.size());
+    parallel_for(surface.faces.size(), [&](size_t f) {
+      if (selected_region_faces[reordering.faces.order[f]]) faces.set(f);
+    });
+    selected_region_faces = std::move(faces);
+  }
+
+  if (device) {
+    if (surface_vertex_curve_closed && !surface_vertex_curve.empty())
+      surface_vertex_curve.push_back(surface_vertex_curve.front());
+    device->surface_vertex_curve_data.allocate_and_initialize(
+        surface_vertex_curve);
+    if (surface_vertex_curve_closed && !surface_vertex_curve.empty())
+      surface_vertex_curve.pop_back();
+    if (selected_vertex != polyhedral_surface::invalid)
+      device->selected_vertices.allocate_and_initialize(selected_vertex);
+    device->selected_region_vertices.allocate_and_initialize(
+        selected_region_vertices);
+    device->selected_region_faces.allocate_and_initialize(
+        selected_region_faces.words);
+    // Pending picks refer to the old face IDs and are dropped
+    // before they can be answered by the next update.
+    device->picks.clear();
+  }
+
+  compute_surface_topology_and_geometry();
+  surface_should_update = true;
+  surface_lods_should_update = true;
+
+  log::info(format("Successfully reordered surface.\nACMR = {:.3f} -> {:.3f}\n"
+                   "time = {} s",
+                   reordering.acmr_before, reordering.acmr_after,
+                   duration(end - start).count()));
+}
+
+void viewer::set_compact_vertices(bool value) {
+  compact_vertices = value;
+  surface_should_update = true;
+}
+
+void viewer::upload_surface_vertices() {
+  // The formats of positions and normals depend on the encoding.
+  // So, they are specified again for every upload.
+  //
+  device->va.bind();
+  device->vertices.bind();
+  aabb3 box{};
+  size_t bytes = 0;
+  if (compact_vertices) {
+    const auto data = quantized_vertices_from(surface.vertices);
+    device->vertices.allocate_and_initialize(data.vertices);
+    glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE,
+                          sizeof(quantized_vertex),
+                          (void*)offsetof(quantized_vertex, position));
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(quantized_vertex),
+                          (void*)offsetof(quantized_vertex, normal));
+    box = data.box;
+    bytes = data.size() * sizeof(quantized_vertex);
+  } else {
+    using vertex = polyhedral_surface::vertex;
+    device->vertices.allocate_and_initialize(surface.vertices);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex),
+                          (void*)offsetof(vertex, position));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex),
+                          (void*)offsetof(vertex, normal));
+    bytes = surface.vertices.size() * sizeof(vertex);
+  }
+
+  // All shaders that read the surface's vertices decode them.
+  //
+  for (auto shader : {&device->shader, &device->level_set_shader,
+                      &device->point_shader, &device->pick_shader,
+                      &device->surface_vertex_curve_shader}) {
+    shader->try_set("quantized", compact_vertices);
+    shader->try_set("quantization_origin", box._min);
+    shader->try_set("quantization_extent", box._max - box._min);
+  }
+
+  log::info(format("Uploaded surface vertices.\ncompact = {}\nsize = {} MiB",
+                   compact_vertices, float32(bytes) / (1 << 20)));
+}
+
+void viewer::set_preview_lod(bool value) {
+  preview_lod_enabled = value;
+  log::info(format("preview LOD = {}", value));
+}
+
+void viewer::build_surface_lods() {
+  cancel_surface_lod_build();
+  if (surface.faces.size() <= preview_face_budget) return;
+  const auto start = clock::now();
+  surface_lod_task = async(launch::async, [this, start] {
+    auto lods = surface_lods_from(surface);
+    log::info(format("Successfully built {} LODs of surface.\ntime = {} s",
+                     lods.size(), duration(clock::now() - start).count()));
+    return lods;
+  });
+}
+
+void viewer::handle_surface_lod_task() {
+  // While loading, the surface is changed by another thread.
+  if (surface_load_task.valid()) return;
+  if (!surface_lod_task.valid()) return;
+  if (future_status::ready != surface_lod_task.wait_for(0s)) return;
+  surface_lods = surface_lod_task.get();
+
+  // LODs are ordered from fine to coarse.
+  //
+  preview_lod = 0;
+  while ((preview_lod < surface_lods.size()) &&
+         (surface_lods[preview_lod].surface.faces.size() >
+          preview_face_budget))
+    ++preview_lod;
+  upload_preview_lod();
+}
+
+void viewer::cancel_surface_lod_build() {
+  // The decimation cannot be interrupted and has to finish first.
+  if (surface_lod_task.valid()) surface_lod_task.wait();
+  surface_lod_task = {};
+  surface_lods.clear();
+  preview_lod = 0;
+}
+
+void viewer::upload_preview_lod() {
+  if (!device || (preview_lod >= surface_lods.size())) return;
+  const auto& lod = surface_lods[preview_lod];
+  device->lod_vertices.allocate_and_initialize(lod.surface.vertices);
+  device->lod_faces.allocate_and_initialize(lod.surface.faces);
+
+  // Every vertex of the LOD shows the occlusion of its origin.
+  //
+  vector<float> ao(lod.origins.size(), 1.0f);
+  if (surface.ambient_occlusion.size() == surface.vertices.size())
+    parallel_for(ao.size(), [&](size_t v) {
+      ao[v] = surface.ambient_occlusion[lod.origins[v]];
+    });
+  device->lod_ambient_occlusion.allocate_and_initialize(ao);
+
+  log::info(format("Uploaded preview LOD.\nfaces = {}\nvertices = {}",
+                   lod.surface.faces.size(), lod.surface.vertices.size()));
+}
+
 }  // namespace ensketch::sandbox
@@ -3,7 +3,16 @@
 //
 #include <SFML/Graphics.hpp>
 //
+#include <ensketch/sandbox/ambient_occlusion.hpp>
+#include <ensketch/sandbox/bvh.hpp>
+#include <ensketch/sandbox/kd_tree.hpp>
+#include <ensketch/sandbox/mesh_decimation.hpp>
+#include <ensketch/sandbox/mesh_reordering.hpp>
+#include <ensketch/sandbox/pick_buffer.hpp>
 #include <ensketch/sandbox/polyhedral_surface.hpp>
+#include <ensketch/sandbox/polyhedral_surface_cache.hpp>
+#include <ensketch/sandbox/selection.hpp>
+#include <ensketch/sandbox/surface_segmentation.hpp>
 //
 #include <geometrycentral/surface/edge_length_geometry.h>
 #include <geometrycentral/surface/manifold_surface_mesh.h>
@@ -53,6 +62,9 @@ class viewer {
   void turn(const vec2& angle);
   void shift(const vec2& pixels);
   void zoom(float scale);
+  // The view is centered at the surface point under the given pixel
+  // as soon as the pick of the pixel has been read back.
+  //
   void look_at(float x, float y);
 
   void set_z_as_up();
@@ -77,11 +89,24 @@ class viewer {
   auto surface_vertex_from(const mouse_position&) noexcept
       -> polyhedral_surface::vertex_id;
 
+  // Return the surface's vertices that best fit the given mouse positions.
+  // All positions are processed at once in parallel.
+  //
+  auto surface_vertices_from(span<const vec2> positions)
+      -> vector<polyhedral_surface::vertex_id>;
+
   void select_surface_vertex_from_mouse(float x, float y) noexcept;
 
   void record_mouse_curve() noexcept;
   void reset_mouse_curve() noexcept;
 
+  // Select all vertices and faces of the surface inside the lasso
+  // given by the mouse curve. Occluded elements are only selected
+  // if `visible_only` is false.
+  //
+  void select_surface_region_from_mouse_curve(bool visible_only = true);
+  void reset_surface_selection();
+
   void project_mouse_curve_to_surface_vertex_curve();
 
   void compute_surface_topology_and_geometry();
@@ -91,7 +116,12 @@ class viewer {
 
   void close_regular_surface_vertex_curve();
 
+  // The vertex under the mouse is picked from the ID buffer
+  // and appended a few frames later without any ray casting.
+  //
   void mouse_append_surface_vertex_curve(float x, float y);
+  void shortest_path_append_to_surface_vertex_curve(
+      polyhedral_surface::vertex_id vid);
   void regular_append_to_surface_vertex_curve(
       polyhedral_surface::vertex_id vid);
 
@@ -119,6 +149,36 @@ class viewer {
   void set_wireframe(bool value);
   void use_face_normal(bool value);
 
+  // Ambient occlusion is baked per vertex in the background
+  // with one pass of rays per task. Every finished pass is uploaded
+  // and shown. The final result is stored in the surface's cache.
+  //
+  void set_ambient_occlusion(bool value);
+  void bake_ambient_occlusion();
+  void handle_ambient_occlusion_task();
+  void cancel_ambient_occlusion_bake();
+
+  // Reorder vertices and faces of the surface for cache locality.
+  // Curves and selections are remapped and stay valid.
+  //
+  void reorder_surface();
+
+  // Vertices may be uploaded with quantized positions and octahedral
+  // normals in half of the memory. The vertex shaders decode them.
+  //
+  void set_compact_vertices(bool value);
+  void upload_surface_vertices();
+
+  // Coarse LODs of large surfaces are built in the background. While
+  // the view changes, the finest LOD within the preview face budget is
+  // drawn instead of the surface. The surface is drawn again when idle.
+  //
+  void set_preview_lod(bool value);
+  void build_surface_lods();
+  void handle_surface_lod_task();
+  void cancel_surface_lod_build();
+  void upload_preview_lod();
+
  private:
   bool _running = false;
 
@@ -165,6 +225,14 @@ class viewer {
 
     opengl::shader_storage_buffer ssbo{};
     opengl::vertex_buffer scalar_field{};
+    opengl::vertex_buffer ambient_occlusion{};
+
+    // Preview LOD of the Surface Mesh
+    //
+    opengl::vertex_array lod_va{};
+    opengl::vertex_buffer lod_vertices{};
+    opengl::element_buffer lod_faces{};
+    opengl::vertex_buffer lod_ambient_occlusion{};
 
     opengl::shader_program level_set_shader{};
 
@@ -173,6 +241,16 @@ class viewer {
     opengl::shader_program point_shader{};
     opengl::element_buffer selected_vertices{};
 
+    // Selected Region on Surface Mesh
+    //
+    opengl::element_buffer selected_region_vertices{};
+    opengl::shader_storage_buffer selected_region_faces{};
+
+    // Face IDs and Barycentric Coordinates for Picking
+    //
+    opengl::shader_program pick_shader{};
+    pick_buffer picks{};
+
     // Surface Vertex Curve
     //
     opengl::shader_program surface_vertex_curve_shader{};
@@ -199,6 +277,23 @@ class viewer {
   // Surface Mesh on Host
   //
   polyhedral_surface surface{};
+  filesystem::path surface_path{};
+  // Stamp of the source file at the time it has been loaded.
+  // Caches are only updated as long as it does not change.
+  polyhedral_surface_cache::stamp surface_stamp{};
+  // Surfaces that have been changed in the viewer, for example
+  // by reordering, do not match their source file anymore.
+  // So, their caches must not be updated.
+  bool surface_modified = false;
+  //
+  // Acceleration structure for ray casting on the surface.
+  // It has to be rebuilt whenever the surface changes.
+  //
+  bvh surface_bvh{};
+  //
+  // Spatial index of the surface's vertices for region queries.
+  //
+  kd_tree surface_kd_tree{};
   //
   bool surface_should_update = false;
   //
@@ -212,12 +307,39 @@ class viewer {
   float32 surface_load_time{};
   float32 surface_process_time{};
   //
+  // The bake references the surface and its BVH. So, it has
+  // to be canceled before any of them is changed.
+  //
+  optional<ambient_occlusion_bake> surface_ambient_occlusion_bake{};
+  future<void> surface_ambient_occlusion_task{};
+  clock::time_point surface_ambient_occlusion_start{};
+  bool ambient_occlusion_enabled = false;
+  bool compact_vertices = false;
+  //
+  // The LODs reference the surface while they are built. So, the build
+  // has to be canceled before the surface is changed. Only the LOD that
+  // is drawn is kept on the device.
+  //
+  future<vector<surface_lod>> surface_lod_task{};
+  vector<surface_lod> surface_lods{};
+  size_t preview_lod = 0;
+  bool preview_lod_enabled = true;
+  bool surface_lods_should_update = false;
+  clock::time_point last_view_change{};
+  //
   float bounding_radius;
 
   // Selected Vertex
   //
   polyhedral_surface::vertex_id selected_vertex = polyhedral_surface::invalid;
 
+  // Selected Region
+  // Vertices are drawn as points and faces are
+  // looked up by their bits in the fragment shader.
+  //
+  vector<polyhedral_surface::vertex_id> selected_region_vertices{};
+  selection_mask selected_region_faces{};
+
   // Mouse Curve and Recording
   //
   vector<vec2> mouse_curve{};
@@ -259,6 +381,12 @@ class viewer {
   //
   size_t laplace_iterations = 10;
   float laplace_relaxation = 0.1f;
+  //
+  // Surfaces with fewer faces are always drawn at full resolution.
+  size_t preview_face_budget = 500'000;
+  // Time in seconds after the last change of the view until
+  // the surface is drawn at full resolution again.
+  float32 preview_delay = 0.2f;
 
   // Hyper Surface Smoothing
   //